@@ -1,67 +1,223 @@
 #include <iostream>
 #include <chrono>
 #include <vector>
-#include <functional>
+#include <map>
+#include <utility>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cctype>
+#include <stdexcept>
 #include "clwe/clwe.hpp"
 #include "src/core/color_kem.hpp"
 #include "src/core/cpu_features.hpp"
+#include "src/core/kernel_dispatch.hpp"
+#include "benchmark_support.hpp"
+
+// Color KEM timing benchmark.
+//
+//   benchmark_color_kem_timing [--iterations N] [--warmup N] [--cpu N] [--keys N] [--flush] [--perf]
+//                              [--json FILE]
+//   benchmark_color_kem_timing --compare BASELINE.json CURRENT.json [--threshold PCT]
+//
+// Every call is timed on its own in nanoseconds and recorded in a histogram,
+// so percentiles keep the outliers a mean hides. --json writes the results
+// ("-" for stdout); --compare reads two such files and exits with status 1
+// when an operation's p50 grew by more than the threshold (default 5%).
+// --perf adds hardware counters per operation (cycles, instructions, IPC,
+// L1D/LLC read misses, branch misses) where perf_event_open allows it; the
+// counters run across the timed loop, so they include the clock reads.
+//
+// By default every call reuses one key pair, so key material stays in L1.
+// --keys N rotates encapsulation and decapsulation through N key pairs
+// (each with its own ciphertext), like a server holding many keys. --flush
+// also evicts the next call's key and ciphertext buffers from every cache
+// level before it starts; the flush is untimed and excluded from counters.
+// The matrix is re-expanded from the seed on every call, so it has no
+// buffer of its own to flush.
 
 using namespace clwe;
+using bench::LatencyHistogram;
+using bench::parse_int;
+using bench::PerfCounters;
+using bench::PerfEvent;
+using bench::PerfSample;
+using bench::pin_to_cpu;
+using bench::to_us;
+
+namespace {
+
+struct Options {
+    int iterations = 1000;
+    int warmup = 50;
+    int cpu = -1;             // -1 leaves scheduling to the OS
+    std::string json_path;
+    std::string compare_baseline;
+    std::string compare_current;
+    double threshold = 5.0;   // Percent
+    bool perf = false;
+    int keys = 1;
+    bool flush = false;
+};
 
-double time_operation(const std::function<void()>& operation, int iterations = 100) {
-    std::vector<double> times;
+using KeyPair = decltype(std::declval<ColorKEM&>().keygen());
+using Encapsulation = decltype(std::declval<ColorKEM&>().encapsulate(std::declval<const KeyPair&>().first));
 
-    for (int i = 0; i < iterations; ++i) {
-        auto start = std::chrono::high_resolution_clock::now();
-        operation();
-        auto end = std::chrono::high_resolution_clock::now();
+// One key pair and a ciphertext under it
+struct KeyMaterial {
+    KeyPair keys;
+    Encapsulation encapsulation;
+};
+
+void flush_key_material(const KeyMaterial& m) {
+    const auto& public_key = m.keys.first;
+    const auto& private_key = m.keys.second;
+    const auto& ciphertext = m.encapsulation.first;
+    bench::flush_cache_lines(&m, sizeof(m));
+    bench::flush_cache_lines(public_key.public_data.data(), public_key.public_data.size());
+    bench::flush_cache_lines(private_key.secret_data.data(), private_key.secret_data.size());
+    bench::flush_cache_lines(ciphertext.ciphertext_data.data(), ciphertext.ciphertext_data.size());
+    bench::flush_cache_lines(ciphertext.shared_secret_hint.data(), ciphertext.shared_secret_hint.size());
+    bench::flush_fence();
+}
+
+struct Measurement {
+    LatencyHistogram histogram;
+    PerfSample perf;   // Totals over all timed iterations; empty without --perf
+};
+
+struct OperationResult {
+    int level;
+    std::string op;
+    Measurement measurement;
+};
+
+// Calls operation(i) for each iteration; with --flush, prepare(i) runs first,
+// outside the timed and counted region
+template<typename Prepare, typename Op>
+Measurement time_operation(Prepare&& prepare, Op&& operation, const Options& options, PerfCounters* perf) {
+    for (int i = 0; i < options.warmup; ++i) {
+        operation(i);
+    }
 
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        times.push_back(static_cast<double>(duration.count()));
+    Measurement m;
+    if (perf) perf->start();
+    for (int i = 0; i < options.iterations; ++i) {
+        if (options.flush) {
+            if (perf) perf->pause();
+            prepare(i);
+            if (perf) perf->resume();
+        }
+        auto start = std::chrono::steady_clock::now();
+        operation(i);
+        auto end = std::chrono::steady_clock::now();
+        m.histogram.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
     }
+    if (perf) m.perf = perf->stop();
+    return m;
+}
+
+// Per-operation value of a counter, or a dash when it is unavailable
+std::string per_op(const PerfSample& sample, PerfEvent event, int iterations, int precision = 0) {
+    if (!sample.has(event)) return "-";
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << sample[event] / iterations;
+    return out.str();
+}
+
+std::string ipc(const PerfSample& sample) {
+    if (!sample.has(PerfEvent::Cycles) || !sample.has(PerfEvent::Instructions) || sample[PerfEvent::Cycles] <= 0) {
+        return "-";
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << sample[PerfEvent::Instructions] / sample[PerfEvent::Cycles];
+    return out.str();
+}
+
+void print_perf_row(const std::string& name, const PerfSample& p, int iterations) {
+    std::cout << std::left << std::setw(18) << name << std::right
+              << std::setw(12) << per_op(p, PerfEvent::Cycles, iterations)
+              << std::setw(12) << per_op(p, PerfEvent::Instructions, iterations)
+              << std::setw(7) << ipc(p)
+              << std::setw(11) << per_op(p, PerfEvent::L1DMisses, iterations, 1)
+              << std::setw(11) << per_op(p, PerfEvent::LLCMisses, iterations, 1)
+              << std::setw(11) << per_op(p, PerfEvent::BranchMisses, iterations, 1) << std::endl;
+}
 
-    
-    double sum = 0;
-    for (double t : times) sum += t;
-    return sum / times.size();
+void print_histogram_row(const std::string& name, const LatencyHistogram& h) {
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(11) << to_us(h.mean())
+              << std::setw(11) << to_us(h.percentile(50))
+              << std::setw(11) << to_us(h.percentile(90))
+              << std::setw(11) << to_us(h.percentile(99))
+              << std::setw(11) << to_us(h.percentile(99.9))
+              << std::setw(11) << to_us(h.max()) << std::endl;
 }
 
-void benchmark_security_level(int security_level) {
+void benchmark_security_level(int security_level, const Options& options, PerfCounters* perf,
+                              std::vector<OperationResult>& results) {
     std::cout << "Security Level: " << security_level << "-bit" << std::endl;
     std::cout << "=====================================" << std::endl;
 
-    
     clwe::CLWEParameters params(security_level);
     clwe::ColorKEM kem(params);
 
-    
-    auto [public_key, private_key] = kem.keygen();
-
-    
-    auto [ciphertext, shared_secret] = kem.encapsulate(public_key);
+    std::vector<KeyMaterial> material;
+    material.reserve(options.keys);
+    for (int i = 0; i < options.keys; ++i) {
+        KeyPair keys = kem.keygen();
+        Encapsulation encapsulation = kem.encapsulate(keys.first);
+        material.push_back({std::move(keys), std::move(encapsulation)});
+    }
+    auto key_at = [&](int i) -> const KeyMaterial& { return material[i % options.keys]; };
+    auto flush_key = [&](int i) { flush_key_material(key_at(i)); };
 
-    
-    double keygen_time = time_operation([&]() {
+    // Key generation reads no stored key; --flush has nothing to evict for it
+    Measurement keygen_run = time_operation([](int) {}, [&](int) {
         auto [pk, sk] = kem.keygen();
-    });
+    }, options, perf);
 
-    
-    double encap_time = time_operation([&]() {
-        auto [ct, ss] = kem.encapsulate(public_key);
-    });
+    Measurement encap_run = time_operation(flush_key, [&](int i) {
+        auto [ct, ss] = kem.encapsulate(key_at(i).keys.first);
+    }, options, perf);
 
-    
-    double decap_time = time_operation([&]() {
-        ColorValue recovered = kem.decapsulate(public_key, private_key, ciphertext);
-    });
+    Measurement decap_run = time_operation(flush_key, [&](int i) {
+        const KeyMaterial& m = key_at(i);
+        ColorValue recovered = kem.decapsulate(m.keys.first, m.keys.second, m.encapsulation.first);
+        (void)recovered;
+    }, options, perf);
 
+    const LatencyHistogram& keygen = keygen_run.histogram;
+    const LatencyHistogram& encap = encap_run.histogram;
+    const LatencyHistogram& decap = decap_run.histogram;
+
+    double keygen_time = to_us(keygen.mean());
+    double encap_time = to_us(encap.mean());
+    double decap_time = to_us(decap.mean());
     double total_kem_time = keygen_time + encap_time + decap_time;
-    double throughput = 1000000.0 / total_kem_time;  
+    double throughput = 1000000.0 / total_kem_time;
 
-    
-    std::cout << "Key Generation:     " << keygen_time << " μs" << std::endl;
-    std::cout << "Encapsulation:      " << encap_time << " μs" << std::endl;
-    std::cout << "Decapsulation:      " << decap_time << " μs" << std::endl;
+    std::cout << std::left << std::setw(18) << "Operation (μs)" << std::right
+              << std::setw(11) << "mean" << std::setw(11) << "p50" << std::setw(11) << "p90"
+              << std::setw(11) << "p99" << std::setw(11) << "p99.9" << std::setw(11) << "max" << std::endl;
+    print_histogram_row("Key Generation", keygen);
+    print_histogram_row("Encapsulation", encap);
+    print_histogram_row("Decapsulation", decap);
+    std::cout << std::endl;
+    if (perf) {
+        std::cout << std::left << std::setw(18) << "Counters (per op)" << std::right
+                  << std::setw(12) << "cycles" << std::setw(12) << "instr" << std::setw(7) << "IPC"
+                  << std::setw(11) << "L1D miss" << std::setw(11) << "LLC miss" << std::setw(11) << "br miss"
+                  << std::endl;
+        print_perf_row("Key Generation", keygen_run.perf, options.iterations);
+        print_perf_row("Encapsulation", encap_run.perf, options.iterations);
+        print_perf_row("Decapsulation", decap_run.perf, options.iterations);
+        std::cout << std::endl;
+    }
     std::cout << "Total KEM Time:     " << total_kem_time << " μs" << std::endl;
     std::cout << "Throughput:         " << throughput << " operations/second" << std::endl;
     std::cout << std::endl;
@@ -71,25 +227,296 @@ void benchmark_security_level(int security_level) {
     std::cout << "  Encap:  " << (encap_time / total_kem_time * 100) << "%" << std::endl;
     std::cout << "  Decap:  " << (decap_time / total_kem_time * 100) << "%" << std::endl;
     std::cout << std::endl;
+
+    results.push_back({security_level, "keygen", keygen_run});
+    results.push_back({security_level, "encapsulate", encap_run});
+    results.push_back({security_level, "decapsulate", decap_run});
+}
+
+std::string json_escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+void write_json(std::ostream& out, const Options& options, const std::vector<OperationResult>& results) {
+    out << "{\n";
+    out << "  \"benchmark\": \"color_kem_timing\",\n";
+    out << "  \"cpu\": \"" << json_escape(CPUFeatureDetector::cached().to_string()) << "\",\n";
+    out << "  \"kernels\": \"" << json_escape(selected_kernels().to_string()) << "\",\n";
+    out << "  \"iterations\": " << options.iterations << ",\n";
+    out << "  \"warmup\": " << options.warmup << ",\n";
+    out << "  \"pinned_cpu\": " << options.cpu << ",\n";
+    out << "  \"keys\": " << options.keys << ",\n";
+    out << "  \"flush\": " << (options.flush ? "true" : "false") << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const LatencyHistogram& h = results[i].measurement.histogram;
+        const PerfSample& p = results[i].measurement.perf;
+        out << "    {\"level\": " << results[i].level << ", \"op\": \"" << results[i].op << "\""
+            << ", \"count\": " << h.count()
+            << ", \"mean_ns\": " << std::fixed << std::setprecision(1) << h.mean()
+            << ", \"min_ns\": " << h.min()
+            << ", \"p50_ns\": " << h.percentile(50)
+            << ", \"p90_ns\": " << h.percentile(90)
+            << ", \"p99_ns\": " << h.percentile(99)
+            << ", \"p999_ns\": " << h.percentile(99.9)
+            << ", \"max_ns\": " << h.max();
+        // Counters per operation, present only when they were read
+        for (size_t e = 0; e < bench::PERF_EVENT_COUNT; ++e) {
+            PerfEvent event = static_cast<PerfEvent>(e);
+            if (p.has(event)) {
+                out << ", \"" << bench::perf_event_name(event) << "\": " << p[event] / options.iterations;
+            }
+        }
+        if (ipc(p) != "-") {
+            out << ", \"ipc\": " << ipc(p);
+        }
+        out << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
 }
 
-int main() {
+// Reads the entries of the "results" array written by write_json. Entries
+// are flat objects; values are kept as text.
+std::vector<std::map<std::string, std::string>> read_json_results(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+
+    size_t pos = text.find("\"results\"");
+    if (pos == std::string::npos || (pos = text.find('[', pos)) == std::string::npos) {
+        throw std::runtime_error(path + " has no results array");
+    }
+
+    auto skip_space = [&] {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    };
+    auto read_string = [&] {
+        if (text[pos] != '"') throw std::runtime_error(path + ": expected a string");
+        size_t end = text.find('"', pos + 1);
+        if (end == std::string::npos) throw std::runtime_error(path + ": unterminated string");
+        std::string value = text.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+        return value;
+    };
+
+    std::vector<std::map<std::string, std::string>> entries;
+    ++pos;
+    for (;;) {
+        skip_space();
+        if (pos >= text.size()) throw std::runtime_error(path + ": unterminated results array");
+        if (text[pos] == ']') break;
+        if (text[pos] == ',') { ++pos; continue; }
+        if (text[pos] != '{') throw std::runtime_error(path + ": expected an object in results");
+        ++pos;
+
+        std::map<std::string, std::string> entry;
+        for (;;) {
+            skip_space();
+            if (pos >= text.size()) throw std::runtime_error(path + ": unterminated object");
+            if (text[pos] == '}') { ++pos; break; }
+            if (text[pos] == ',') { ++pos; continue; }
+            std::string key = read_string();
+            skip_space();
+            if (pos >= text.size() || text[pos] != ':') throw std::runtime_error(path + ": expected ':'");
+            ++pos;
+            skip_space();
+            if (pos < text.size() && text[pos] == '"') {
+                entry[key] = read_string();
+            } else {
+                size_t end = text.find_first_of(",}", pos);
+                if (end == std::string::npos) throw std::runtime_error(path + ": unterminated object");
+                std::string value = text.substr(pos, end - pos);
+                while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) value.pop_back();
+                entry[key] = value;
+                pos = end;
+            }
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+double percent_change(double baseline, double current) {
+    return baseline > 0 ? (current - baseline) / baseline * 100.0 : 0.0;
+}
+
+// Returns the process exit status: 0 when nothing regressed, 1 otherwise
+int compare_results(const Options& options) {
+    auto baseline = read_json_results(options.compare_baseline);
+    auto current = read_json_results(options.compare_current);
+
+    std::map<std::string, std::map<std::string, std::string>> current_by_key;
+    for (const auto& entry : current) {
+        current_by_key[entry.at("level") + "/" + entry.at("op")] = entry;
+    }
+
+    std::cout << "Comparing " << options.compare_current << " against " << options.compare_baseline
+              << " (threshold " << options.threshold << "% on p50)" << std::endl;
+    std::cout << std::left << std::setw(20) << "Operation" << std::right
+              << std::setw(14) << "base p50 μs" << std::setw(14) << "new p50 μs" << std::setw(10) << "p50 Δ%"
+              << std::setw(10) << "p99 Δ%" << "  Status" << std::endl;
+
+    int regressions = 0;
+    for (const auto& base : baseline) {
+        const std::string key = base.at("level") + "/" + base.at("op");
+        auto found = current_by_key.find(key);
+        if (found == current_by_key.end()) {
+            std::cout << std::left << std::setw(20) << key << "  missing from current results" << std::endl;
+            continue;
+        }
+        const auto& now = found->second;
+        double base_p50 = std::atof(base.at("p50_ns").c_str());
+        double now_p50 = std::atof(now.at("p50_ns").c_str());
+        double p50_change = percent_change(base_p50, now_p50);
+        double p99_change = percent_change(std::atof(base.at("p99_ns").c_str()), std::atof(now.at("p99_ns").c_str()));
+
+        const char* status = "ok";
+        if (p50_change > options.threshold) {
+            status = "REGRESSION";
+            regressions++;
+        } else if (p50_change < -options.threshold) {
+            status = "improved";
+        }
+        std::cout << std::left << std::setw(20) << key << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << to_us(base_p50) << std::setw(14) << to_us(now_p50)
+                  << std::setprecision(1) << std::setw(10) << p50_change << std::setw(10) << p99_change
+                  << "  " << status << std::endl;
+    }
+
+    std::cout << std::endl << regressions << " regression(s)" << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--iterations" && has_value) {
+            if (!parse_int(argv[++i], 1, options.iterations)) return false;
+        } else if (arg == "--warmup" && has_value) {
+            if (!parse_int(argv[++i], 0, options.warmup)) return false;
+        } else if (arg == "--keys" && has_value) {
+            if (!parse_int(argv[++i], 1, options.keys)) return false;
+        } else if (arg == "--flush") {
+            options.flush = true;
+        } else if (arg == "--perf") {
+            options.perf = true;
+        } else if (arg == "--cpu" && has_value) {
+            if (!parse_int(argv[++i], 0, options.cpu)) return false;
+        } else if (arg == "--json" && has_value) {
+            options.json_path = argv[++i];
+        } else if (arg == "--compare" && i + 2 < argc) {
+            options.compare_baseline = argv[++i];
+            options.compare_current = argv[++i];
+        } else if (arg == "--threshold" && has_value) {
+            char* end = nullptr;
+            options.threshold = std::strtod(argv[++i], &end);
+            if (*end != '\0' || options.threshold < 0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--iterations N] [--warmup N] [--cpu N] [--keys N] [--flush]"
+                  << " [--perf] [--json FILE]\n"
+                  << "       " << argv[0] << " --compare BASELINE.json CURRENT.json [--threshold PCT]" << std::endl;
+        return 2;
+    }
+
+    if (!options.compare_baseline.empty()) {
+        try {
+            return compare_results(options);
+        } catch (const std::exception& e) {
+            std::cerr << "compare failed: " << e.what() << std::endl;
+            return 2;
+        }
+    }
+
+    // JSON on stdout replaces the human-readable report
+    std::ostringstream discarded;
+    std::streambuf* stdout_buffer = std::cout.rdbuf();
+    if (options.json_path == "-") {
+        std::cout.rdbuf(discarded.rdbuf());
+    }
+
     std::cout << "🎨 CLWE Color KEM Timing Benchmark" << std::endl;
     std::cout << "===================================" << std::endl;
 
-    
-    CPUFeatures features = CPUFeatureDetector::detect();
+    const CPUFeatures& features = CPUFeatureDetector::cached();
     std::cout << "CPU: " << features.to_string() << std::endl;
+    std::cout << "Kernels: " << selected_kernels().to_string() << std::endl;
+    if (options.cpu >= 0) {
+        if (pin_to_cpu(options.cpu)) {
+            std::cout << "Pinned to CPU " << options.cpu << std::endl;
+        } else {
+            std::cerr << "warning: could not pin to CPU " << options.cpu << "; running unpinned" << std::endl;
+            options.cpu = -1;
+        }
+    }
+    std::unique_ptr<PerfCounters> perf;
+    if (options.perf) {
+        perf = std::make_unique<PerfCounters>();
+        if (!perf->available()) {
+            std::cerr << "warning: hardware counters unavailable (" << perf->error() << "); timing only" << std::endl;
+            perf.reset();
+        } else if (!perf->error().empty()) {
+            std::cerr << "warning: some hardware counters unavailable (" << perf->error() << ")" << std::endl;
+        }
+    }
+    if (options.flush && !bench::cache_flush_supported()) {
+        std::cerr << "warning: cache flushing is not supported on this architecture; --flush ignored" << std::endl;
+        options.flush = false;
+    }
+    std::cout << "Iterations: " << options.iterations << " (warmup " << options.warmup << ")" << std::endl;
+    std::cout << "Working set: " << options.keys << (options.keys == 1 ? " key" : " keys")
+              << (options.flush ? ", key buffers flushed before each call" : "") << std::endl;
     std::cout << std::endl;
 
-    
     std::vector<int> security_levels = {128, 192, 256};
+    std::vector<OperationResult> results;
 
     for (int level : security_levels) {
-        benchmark_security_level(level);
+        benchmark_security_level(level, options, perf.get(), results);
     }
 
     std::cout << "Benchmark completed successfully!" << std::endl;
+    std::cout.rdbuf(stdout_buffer);
+
+    if (options.json_path == "-") {
+        write_json(std::cout, options, results);
+    } else if (!options.json_path.empty()) {
+        std::ofstream out(options.json_path);
+        if (!out) {
+            std::cerr << "Cannot write " << options.json_path << std::endl;
+            return 1;
+        }
+        write_json(out, options, results);
+        std::cout << "Results written to " << options.json_path << std::endl;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,322 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+#include "clwe/clwe.hpp"
+#include "src/core/color_kem.hpp"
+#include "src/core/pool_allocator.hpp"
+#include "benchmark_support.hpp"
+
+// Allocation accounting for the color KEM.
+//
+//   benchmark_kem_allocations [--iterations N] [--level BITS] [--arena BYTES] [--assert-zero] [--heap-only]
+//
+// This executable replaces the global operator new/delete and installs a
+// PoolAllocator::Observer. For each keygen/encapsulate/decapsulate call it
+// reports:
+//   heap: operator new calls, bytes and peak live bytes. This includes the
+//         blocks the pool takes from the system.
+//   pool: PoolAllocator blocks handed out (AVXAllocator, AlignedAllocator
+//         and the default memory resource), bytes and peak live bytes.
+// Figures are per-call averages; peaks are the worst call. One unmeasured
+// call per operation runs first, so lazy initialisation is not counted.
+//
+// --arena passes each call a monotonic_buffer_resource over a preallocated
+// buffer of that size, which shows what is left once scratch allocations
+// are routed away from the global allocators. --assert-zero exits with
+// status 1 when any operation allocates; --heap-only restricts that check
+// to operator new, so pool reuse passes.
+
+namespace {
+
+struct Counters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> live{0};
+    std::atomic<uint64_t> peak{0};
+
+    void on_allocate(size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        uint64_t now = live.fetch_add(size, std::memory_order_relaxed) + size;
+        uint64_t seen = peak.load(std::memory_order_relaxed);
+        while (now > seen && !peak.compare_exchange_weak(seen, now, std::memory_order_relaxed)) {
+        }
+    }
+
+    void on_deallocate(size_t size) {
+        live.fetch_sub(size, std::memory_order_relaxed);
+    }
+};
+
+// Constant-initialised, so usable by allocations made before main()
+Counters heap_counters;
+Counters pool_counters;
+
+class PoolCounter : public clwe::PoolAllocator::Observer {
+public:
+    void on_allocate(size_t bytes) override { pool_counters.on_allocate(bytes); }
+    void on_deallocate(size_t bytes) override { pool_counters.on_deallocate(bytes); }
+};
+
+// The requested size sits just in front of the returned pointer
+constexpr size_t BASE_HEADER = alignof(std::max_align_t);
+
+size_t header_size(size_t alignment) {
+    return std::max(BASE_HEADER, alignment);
+}
+
+void* counted_allocate(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+    const size_t header = header_size(alignment);
+    void* raw;
+    if (alignment <= BASE_HEADER) {
+        raw = std::malloc(header + size);
+    } else {
+#ifdef _MSC_VER
+        raw = _aligned_malloc(header + size, alignment);
+#else
+        raw = std::aligned_alloc(alignment, (header + size + alignment - 1) / alignment * alignment);
+#endif
+    }
+    if (!raw) return nullptr;
+    char* ptr = static_cast<char*>(raw) + header;
+    reinterpret_cast<size_t*>(ptr)[-1] = size;
+    heap_counters.on_allocate(size);
+    return ptr;
+}
+
+void counted_deallocate(void* ptr, size_t alignment) {
+    if (!ptr) return;
+    heap_counters.on_deallocate(reinterpret_cast<size_t*>(ptr)[-1]);
+    char* raw = static_cast<char*>(ptr) - header_size(alignment);
+#ifdef _MSC_VER
+    if (alignment > BASE_HEADER) {
+        _aligned_free(raw);
+        return;
+    }
+#endif
+    std::free(raw);
+}
+
+void* counted_allocate_or_throw(size_t size, size_t alignment) {
+    void* ptr = counted_allocate(size, alignment);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return counted_allocate_or_throw(size, BASE_HEADER); }
+void* operator new[](size_t size) { return counted_allocate_or_throw(size, BASE_HEADER); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size, BASE_HEADER); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size, BASE_HEADER); }
+void* operator new(size_t size, std::align_val_t al) { return counted_allocate_or_throw(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return counted_allocate_or_throw(size, static_cast<size_t>(al)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return counted_allocate(size, static_cast<size_t>(al));
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return counted_allocate(size, static_cast<size_t>(al));
+}
+
+void operator delete(void* ptr) noexcept { counted_deallocate(ptr, BASE_HEADER); }
+void operator delete[](void* ptr) noexcept { counted_deallocate(ptr, BASE_HEADER); }
+void operator delete(void* ptr, size_t) noexcept { counted_deallocate(ptr, BASE_HEADER); }
+void operator delete[](void* ptr, size_t) noexcept { counted_deallocate(ptr, BASE_HEADER); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_deallocate(ptr, BASE_HEADER); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_deallocate(ptr, BASE_HEADER); }
+void operator delete(void* ptr, std::align_val_t al) noexcept { counted_deallocate(ptr, static_cast<size_t>(al)); }
+void operator delete[](void* ptr, std::align_val_t al) noexcept { counted_deallocate(ptr, static_cast<size_t>(al)); }
+void operator delete(void* ptr, size_t, std::align_val_t al) noexcept { counted_deallocate(ptr, static_cast<size_t>(al)); }
+void operator delete[](void* ptr, size_t, std::align_val_t al) noexcept {
+    counted_deallocate(ptr, static_cast<size_t>(al));
+}
+void operator delete(void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept {
+    counted_deallocate(ptr, static_cast<size_t>(al));
+}
+void operator delete[](void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept {
+    counted_deallocate(ptr, static_cast<size_t>(al));
+}
+
+using namespace clwe;
+
+namespace {
+
+struct Options {
+    int iterations = 20;
+    std::vector<int> levels = {128, 192, 256};
+    size_t arena_bytes = 0;   // 0: no caller-provided resource
+    bool assert_zero = false;
+    bool heap_only = false;
+};
+
+struct LayerProfile {
+    double allocations = 0;   // Per call
+    double bytes = 0;         // Per call
+    uint64_t peak = 0;        // Worst call, above the live bytes at its start
+};
+
+struct AllocationProfile {
+    std::string name;
+    int level;
+    LayerProfile heap;
+    LayerProfile pool;
+};
+
+struct Snapshot {
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t live;
+};
+
+Snapshot begin_call(Counters& c) {
+    Snapshot s{c.allocations.load(), c.bytes.load(), c.live.load()};
+    c.peak.store(s.live);
+    return s;
+}
+
+void end_call(Counters& c, const Snapshot& start, LayerProfile& profile) {
+    profile.allocations += static_cast<double>(c.allocations.load() - start.allocations);
+    profile.bytes += static_cast<double>(c.bytes.load() - start.bytes);
+    profile.peak = std::max<uint64_t>(profile.peak, c.peak.load() - start.live);
+}
+
+template<typename Op>
+AllocationProfile profile_operation(const std::string& name, int level, const Options& options, Op&& operation) {
+    std::vector<char> buffer(options.arena_bytes);
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    std::pmr::memory_resource* resource = options.arena_bytes ? &arena : nullptr;
+
+    operation(resource);
+    arena.release();
+
+    AllocationProfile profile{name, level, {}, {}};
+    for (int i = 0; i < options.iterations; ++i) {
+        Snapshot heap = begin_call(heap_counters);
+        Snapshot pool = begin_call(pool_counters);
+        operation(resource);
+        end_call(heap_counters, heap, profile.heap);
+        end_call(pool_counters, pool, profile.pool);
+        arena.release();
+    }
+    for (LayerProfile* layer : {&profile.heap, &profile.pool}) {
+        layer->allocations /= options.iterations;
+        layer->bytes /= options.iterations;
+    }
+    return profile;
+}
+
+void print_profile(const AllocationProfile& p) {
+    std::cout << std::left << std::setw(16) << p.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << p.heap.allocations << std::setw(13) << std::setprecision(0) << p.heap.bytes
+              << std::setw(12) << p.heap.peak << std::setprecision(1) << std::setw(12) << p.pool.allocations
+              << std::setprecision(0) << std::setw(13) << p.pool.bytes << std::setw(12) << p.pool.peak << std::endl;
+}
+
+void profile_level(int level, const Options& options, std::vector<AllocationProfile>& profiles) {
+    std::cout << "Security Level: " << level << "-bit" << std::endl;
+    std::cout << std::left << std::setw(16) << "Operation" << std::right << std::setw(12) << "heap allocs"
+              << std::setw(13) << "heap bytes" << std::setw(12) << "heap peak" << std::setw(12) << "pool allocs"
+              << std::setw(13) << "pool bytes" << std::setw(12) << "pool peak" << std::endl;
+
+    clwe::CLWEParameters params(level);
+    ColorKEM kem(params);
+    auto [public_key, private_key] = kem.keygen();
+    auto [ciphertext, shared_secret] = kem.encapsulate(public_key);
+
+    profiles.push_back(profile_operation("keygen", level, options, [&](std::pmr::memory_resource* r) {
+        auto [pk, sk] = kem.keygen(r);
+    }));
+    print_profile(profiles.back());
+    profiles.push_back(profile_operation("encapsulate", level, options, [&](std::pmr::memory_resource* r) {
+        auto [ct, ss] = kem.encapsulate(public_key, r);
+    }));
+    print_profile(profiles.back());
+    profiles.push_back(profile_operation("decapsulate", level, options, [&](std::pmr::memory_resource* r) {
+        ColorValue recovered = kem.decapsulate(public_key, private_key, ciphertext, r);
+        (void)recovered;
+    }));
+    print_profile(profiles.back());
+    std::cout << std::endl;
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--iterations" && has_value) {
+            if (!bench::parse_int(argv[++i], 1, options.iterations)) return false;
+        } else if (arg == "--level" && has_value) {
+            int level = 0;
+            if (!bench::parse_int(argv[++i], 1, level)) return false;
+            if (level != 128 && level != 192 && level != 256) return false;
+            options.levels = {level};
+        } else if (arg == "--arena" && has_value) {
+            if (!bench::parse_int(argv[++i], size_t(1), options.arena_bytes)) return false;
+        } else if (arg == "--assert-zero") {
+            options.assert_zero = true;
+        } else if (arg == "--heap-only") {
+            options.heap_only = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--iterations N] [--level 128|192|256] [--arena BYTES]"
+                  << " [--assert-zero] [--heap-only]" << std::endl;
+        return 2;
+    }
+
+    PoolCounter pool_counter;
+    PoolAllocator::set_observer(&pool_counter);
+
+    std::cout << "CLWE Color KEM Allocation Profile" << std::endl;
+    std::cout << "=================================" << std::endl;
+    std::cout << "Per call, averaged over " << options.iterations << " calls; peaks are the worst call";
+    if (options.arena_bytes) {
+        std::cout << "; scratch arena of " << options.arena_bytes << " bytes";
+    }
+    std::cout << std::endl << std::endl;
+
+    std::vector<AllocationProfile> profiles;
+    for (int level : options.levels) {
+        profile_level(level, options, profiles);
+    }
+    PoolAllocator::set_observer(nullptr);
+
+    if (!options.assert_zero) {
+        return 0;
+    }
+
+    int failures = 0;
+    for (const AllocationProfile& p : profiles) {
+        double allocations = p.heap.allocations + (options.heap_only ? 0.0 : p.pool.allocations);
+        if (allocations > 0) {
+            std::cout << "FAIL: " << p.name << " (" << p.level << "-bit) allocates " << std::setprecision(1)
+                      << p.heap.allocations << " heap";
+            if (!options.heap_only) {
+                std::cout << " + " << p.pool.allocations << " pool";
+            }
+            std::cout << " blocks per call" << std::endl;
+            failures++;
+        }
+    }
+    if (failures == 0) {
+        std::cout << "PASS: no " << (options.heap_only ? "heap " : "") << "allocations on measured paths" << std::endl;
+    }
+    return failures ? 1 : 0;
+}
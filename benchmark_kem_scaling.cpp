@@ -0,0 +1,263 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "clwe/clwe.hpp"
+#include "src/core/color_kem.hpp"
+#include "src/core/cpu_features.hpp"
+#include "src/core/kernel_dispatch.hpp"
+#include "benchmark_support.hpp"
+
+// Multi-core scaling benchmark for the color KEM.
+//
+//   benchmark_kem_scaling [--threads N] [--duration MS] [--level BITS] [--op NAME] [--pin] [--per-thread]
+//
+// For 1, 2, 4, ... up to N worker threads (default: the topology's thread
+// count) each worker owns a ColorKEM and its own keys, and all of them run
+// one operation for a fixed duration. With --pin, worker i is bound to the
+// i-th CPU of the process affinity mask (wrapping when there are more
+// workers than CPUs). The report gives total ops/sec,
+// speedup and efficiency against one thread, and latency percentiles over
+// every call. Anything the workers share (rand(), the pool allocator) shows
+// up as efficiency below 100% and a widening p99.
+
+using namespace clwe;
+using bench::LatencyHistogram;
+using bench::parse_int;
+using bench::to_us;
+
+namespace {
+
+enum class Operation { KeyGen, Encapsulate, Decapsulate };
+
+const char* operation_name(Operation op) {
+    switch (op) {
+        case Operation::KeyGen: return "keygen";
+        case Operation::Encapsulate: return "encapsulate";
+        case Operation::Decapsulate: return "decapsulate";
+        default: return "unknown";
+    }
+}
+
+struct Options {
+    int max_threads = 0;    // 0: CPUTopology::default_thread_count()
+    int duration_ms = 1000;
+    int level = 128;
+    std::vector<Operation> ops = {Operation::KeyGen, Operation::Encapsulate, Operation::Decapsulate};
+    bool pin = false;
+    bool per_thread = false;
+};
+
+struct WorkerResult {
+    LatencyHistogram histogram;
+    double elapsed_ns = 0;
+    bool pinned = false;
+};
+
+struct RunResult {
+    int threads;
+    double ops_per_sec;
+    LatencyHistogram histogram;
+    std::vector<WorkerResult> workers;
+};
+
+void worker_loop(Operation op, int level, int index, const Options& options, const std::vector<int>& cpus,
+                 std::atomic<int>& ready, std::atomic<bool>& go, WorkerResult& result) {
+    if (options.pin) {
+        result.pinned = bench::pin_to_cpu(cpus[index % cpus.size()]);
+    }
+
+    // Setup outside the timed window: own engine, own keys
+    clwe::CLWEParameters params(level);
+    ColorKEM kem(params);
+    auto [public_key, private_key] = kem.keygen();
+    auto [ciphertext, shared_secret] = kem.encapsulate(public_key);
+
+    ready.fetch_add(1, std::memory_order_release);
+    while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(options.duration_ms);
+    auto now = start;
+    while (now < deadline) {
+        auto call_start = now;
+        switch (op) {
+            case Operation::KeyGen: {
+                auto [pk, sk] = kem.keygen();
+                break;
+            }
+            case Operation::Encapsulate: {
+                auto [ct, ss] = kem.encapsulate(public_key);
+                break;
+            }
+            case Operation::Decapsulate: {
+                ColorValue recovered = kem.decapsulate(public_key, private_key, ciphertext);
+                (void)recovered;
+                break;
+            }
+        }
+        now = std::chrono::steady_clock::now();
+        result.histogram.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - call_start).count()));
+    }
+    result.elapsed_ns = std::chrono::duration<double, std::nano>(now - start).count();
+}
+
+RunResult run_threads(Operation op, int threads, const Options& options, const std::vector<int>& cpus) {
+    RunResult run;
+    run.threads = threads;
+    run.workers.resize(threads);
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        pool.emplace_back(worker_loop, op, options.level, i, std::cref(options), std::cref(cpus),
+                          std::ref(ready), std::ref(go), std::ref(run.workers[i]));
+    }
+    while (ready.load(std::memory_order_acquire) < threads) {
+        std::this_thread::yield();
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    run.ops_per_sec = 0;
+    for (const WorkerResult& w : run.workers) {
+        if (w.elapsed_ns > 0) {
+            run.ops_per_sec += w.histogram.count() / w.elapsed_ns * 1e9;
+        }
+        run.histogram.merge(w.histogram);
+    }
+    return run;
+}
+
+std::vector<int> thread_counts(int max_threads) {
+    std::vector<int> counts;
+    for (int t = 1; t < max_threads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+void print_per_thread(const RunResult& run) {
+    for (size_t i = 0; i < run.workers.size(); ++i) {
+        const WorkerResult& w = run.workers[i];
+        double ops = w.elapsed_ns > 0 ? w.histogram.count() / w.elapsed_ns * 1e9 : 0;
+        std::cout << "    thread " << std::left << std::setw(4) << i << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(10) << ops << " ops/s" << std::setprecision(2)
+                  << "   p50 " << std::setw(9) << to_us(w.histogram.percentile(50))
+                  << "   p99 " << std::setw(9) << to_us(w.histogram.percentile(99))
+                  << "   max " << std::setw(9) << to_us(w.histogram.max()) << " μs"
+                  << (w.pinned ? ", pinned" : "") << std::endl;
+    }
+}
+
+void benchmark_operation(Operation op, const Options& options, const std::vector<int>& cpus) {
+    std::cout << operation_name(op) << " (" << options.level << "-bit)" << std::endl;
+    std::cout << std::left << std::setw(9) << "Threads" << std::right << std::setw(13) << "ops/sec"
+              << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << std::setw(11) << "p50 μs"
+              << std::setw(11) << "p99 μs" << std::setw(11) << "max μs" << std::endl;
+
+    double single_thread = 0;
+    for (int threads : thread_counts(options.max_threads)) {
+        RunResult run = run_threads(op, threads, options, cpus);
+        if (threads == 1) single_thread = run.ops_per_sec;
+        double speedup = single_thread > 0 ? run.ops_per_sec / single_thread : 0;
+
+        std::cout << std::left << std::setw(9) << threads << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(13) << run.ops_per_sec << std::setprecision(2) << std::setw(10) << speedup
+                  << std::setprecision(1) << std::setw(11) << speedup / threads * 100 << "%"
+                  << std::setprecision(2) << std::setw(11) << to_us(run.histogram.percentile(50))
+                  << std::setw(11) << to_us(run.histogram.percentile(99))
+                  << std::setw(11) << to_us(run.histogram.max()) << std::endl;
+        if (options.per_thread) {
+            print_per_thread(run);
+        }
+        if (options.pin) {
+            const auto unpinned = std::count_if(run.workers.begin(), run.workers.end(),
+                                                [](const WorkerResult& w) { return !w.pinned; });
+            if (unpinned > 0) {
+                std::cerr << "warning: " << unpinned << " of " << threads
+                          << " threads could not be pinned and ran unbound" << std::endl;
+            }
+        }
+    }
+    std::cout << std::endl;
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) {
+            if (!parse_int(argv[++i], 1, options.max_threads)) return false;
+        } else if (arg == "--duration" && has_value) {
+            if (!parse_int(argv[++i], 1, options.duration_ms)) return false;
+        } else if (arg == "--level" && has_value) {
+            if (!parse_int(argv[++i], 1, options.level)) return false;
+            if (options.level != 128 && options.level != 192 && options.level != 256) return false;
+        } else if (arg == "--op" && has_value) {
+            std::string name = argv[++i];
+            if (name == "all") continue;
+            options.ops.clear();
+            for (Operation op : {Operation::KeyGen, Operation::Encapsulate, Operation::Decapsulate}) {
+                if (name == operation_name(op)) options.ops.push_back(op);
+            }
+            if (options.ops.empty()) return false;
+        } else if (arg == "--pin") {
+            options.pin = true;
+        } else if (arg == "--per-thread") {
+            options.per_thread = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--threads N] [--duration MS] [--level 128|192|256]"
+                  << " [--op keygen|encapsulate|decapsulate|all] [--pin] [--per-thread]" << std::endl;
+        return 2;
+    }
+
+    const CPUFeatures& features = CPUFeatureDetector::cached();
+    const std::vector<int> cpus =
+        bench::allowed_cpus(std::max<int>(1, static_cast<int>(features.topology.logical_cores)));
+    if (options.max_threads == 0) {
+        options.max_threads = static_cast<int>(features.topology.default_thread_count());
+    }
+
+    std::cout << "CLWE Color KEM Scaling Benchmark" << std::endl;
+    std::cout << "================================" << std::endl;
+    std::cout << "CPU: " << features.to_string() << std::endl;
+    std::cout << "Kernels: " << selected_kernels().to_string() << std::endl;
+    std::cout << "Threads: up to " << options.max_threads << ", " << options.duration_ms << " ms per run"
+              << (options.pin ? ", pinned" : "") << std::endl;
+    if (options.pin) {
+        std::cout << "CPUs:";
+        for (int cpu : cpus) std::cout << " " << cpu;
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+
+    for (Operation op : options.ops) {
+        benchmark_operation(op, options, cpus);
+    }
+    return 0;
+}
@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "clwe/clwe.hpp"
+#include "clwe/instrumentation.hpp"
+#include "clwe/ring_operations.hpp"
+#include "clwe/sign.hpp"
+#include "src/core/color_ntt_engine.hpp"
+#include "src/core/cpu_features.hpp"
+#include "src/core/kernel_dispatch.hpp"
+#include "src/core/ntt_avx.hpp"
+#include "src/core/ntt_engine.hpp"
+#include "src/core/poly_packing.hpp"
+#include "src/core/polynomial.hpp"
+#include "src/core/shake_sampler.hpp"
+#include "benchmark_support.hpp"
+
+// Per-kernel microbenchmarks.
+//
+// Every kernel runs in batches sized so one batch takes at least
+// MIN_BATCH_NS; each batch gives one per-call sample. cycles/op is the
+// median, ns/op the mean, p50/p99 are nanosecond percentiles over the samples,
+// and MB/s is the coefficient data one call consumes divided by the median time. Cycles
+// come from read_cycle_counter() (the TSC on x86, so reference cycles).
+//
+// Usage: benchmark_kernels [--filter TEXT] [--samples N] [--csv]
+
+using namespace clwe;
+
+namespace {
+
+constexpr double MIN_BATCH_NS = 20000.0;
+constexpr size_t DEFAULT_SAMPLES = 101;
+
+struct Options {
+    std::string filter;
+    size_t samples = DEFAULT_SAMPLES;
+    bool csv = false;
+};
+
+struct ParameterSet {
+    std::string name;
+    clwe::CLWEParameters params;
+};
+
+struct KernelStats {
+    double cycles;
+    double ns;
+    double p50;
+    double p99;
+    double mb_per_sec;
+};
+
+double percentile(std::vector<double> values, double fraction) {
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+template<typename Op>
+KernelStats measure(Op&& op, size_t bytes, size_t samples) {
+    // Warm up and size batches so timer overhead stays small
+    uint64_t iterations = 1;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) op();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= MIN_BATCH_NS || iterations >= (1u << 24)) break;
+        iterations *= 2;
+    }
+
+    std::vector<double> ns(samples), cycles(samples);
+    for (size_t s = 0; s < samples; ++s) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t c0 = read_cycle_counter();
+        for (uint64_t i = 0; i < iterations; ++i) op();
+        uint64_t c1 = read_cycle_counter();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        ns[s] = elapsed / iterations;
+        cycles[s] = static_cast<double>(c1 - c0) / iterations;
+    }
+
+    KernelStats stats;
+    stats.cycles = percentile(cycles, 0.5);
+    stats.p50 = percentile(ns, 0.5);
+    stats.p99 = percentile(ns, 0.99);
+    double total = 0;
+    for (double t : ns) total += t;
+    stats.ns = total / samples;
+    stats.mb_per_sec = stats.p50 > 0 ? bytes / stats.p50 * 1e3 : 0;
+    return stats;
+}
+
+class Reporter {
+private:
+    const Options& options_;
+
+public:
+    explicit Reporter(const Options& options) : options_(options) {
+        if (options_.csv) {
+            std::cout << "params,kernel,variant,cycles_per_op,ns_per_op,p50_ns,p99_ns,mb_per_sec" << std::endl;
+        } else {
+            std::cout << std::left << std::setw(10) << "Params" << std::setw(18) << "Kernel"
+                      << std::setw(22) << "Variant" << std::right << std::setw(12) << "cycles/op"
+                      << std::setw(12) << "ns/op" << std::setw(12) << "p50 ns" << std::setw(12) << "p99 ns"
+                      << std::setw(12) << "MB/s" << std::endl;
+        }
+    }
+
+    bool wanted(const std::string& params, const std::string& kernel, const std::string& variant) const {
+        if (options_.filter.empty()) return true;
+        std::string name = params + " " + kernel + " " + variant;
+        return name.find(options_.filter) != std::string::npos;
+    }
+
+    template<typename Op>
+    void run(const std::string& params, const std::string& kernel, const std::string& variant,
+             size_t bytes, Op&& op) {
+        if (!wanted(params, kernel, variant)) return;
+        KernelStats s = measure(op, bytes, options_.samples);
+        if (options_.csv) {
+            std::cout << params << ',' << kernel << ',' << variant << ',' << std::fixed << std::setprecision(1)
+                      << s.cycles << ',' << s.ns << ',' << s.p50 << ',' << s.p99 << ',' << s.mb_per_sec << std::endl;
+        } else {
+            std::cout << std::left << std::setw(10) << params << std::setw(18) << kernel << std::setw(22) << variant
+                      << std::right << std::fixed << std::setprecision(1) << std::setw(12) << s.cycles
+                      << std::setw(12) << s.ns << std::setw(12) << s.p50 << std::setw(12) << s.p99
+                      << std::setw(12) << s.mb_per_sec << std::endl;
+        }
+    }
+};
+
+uint32_t coefficient_bits(uint32_t q) {
+    uint32_t bits = 0;
+    while ((q - 1) >> bits) ++bits;
+    return bits;
+}
+
+std::vector<uint32_t> random_coeffs(uint32_t n, uint32_t q, uint32_t seed) {
+    std::vector<uint32_t> coeffs(n);
+    uint32_t x = seed * 2654435761u + 1;
+    for (uint32_t i = 0; i < n; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        coeffs[i] = x % q;
+    }
+    return coeffs;
+}
+
+void benchmark_ntt(Reporter& reporter, const ParameterSet& set) {
+    const uint32_t n = set.params.degree;
+    const uint32_t q = set.params.modulus;
+    const size_t poly_bytes = n * sizeof(uint32_t);
+    const std::vector<uint32_t> a = random_coeffs(n, q, 1);
+    const std::vector<uint32_t> b = random_coeffs(n, q, 2);
+
+    // Portable engine and the color engine, both on plain uint32_t arrays
+    std::unique_ptr<NTTEngine> scalar = create_ntt_engine(SIMDSupport::NONE, q, n);
+    ColorNTTEngine color(q, n);
+    for (NTTEngine* engine : {scalar.get(), static_cast<NTTEngine*>(&color)}) {
+        const std::string variant = engine == scalar.get() ? "scalar-engine" : "color-engine";
+        std::vector<uint32_t> x(a), y(b), r(n);
+        reporter.run(set.name, "ntt_forward", variant, poly_bytes, [&] { engine->ntt_forward(x.data()); });
+        reporter.run(set.name, "ntt_inverse", variant, poly_bytes, [&] { engine->ntt_inverse(x.data()); });
+        reporter.run(set.name, "multiply", variant, 2 * poly_bytes,
+                     [&] { engine->multiply(x.data(), y.data(), r.data()); });
+    }
+
+    // AVXNTTEngine at every tier the host can run
+    const KernelTier top = active_kernel_tier();
+    for (KernelTier tier : {KernelTier::Scalar, KernelTier::AVX2, KernelTier::AVX512}) {
+        if (tier > top) break;
+        AVXNTTEngine engine(q, n, ReductionStrategy::Montgomery, tier);
+        const std::string variant = std::string("avx-engine/") + kernel_tier_name(tier);
+        // 64-byte aligned coefficient buffers viewed as AVX2 lanes
+        AlignedVector<uint32_t> x_buf(n), y_buf(n), r_buf(n);
+        __m256i* x = reinterpret_cast<__m256i*>(x_buf.data());
+        __m256i* y = reinterpret_cast<__m256i*>(y_buf.data());
+        __m256i* r = reinterpret_cast<__m256i*>(r_buf.data());
+        engine.copy_from_uint32(a.data(), x);
+        engine.copy_from_uint32(b.data(), y);
+        engine.ntt_forward_avx(y);
+        reporter.run(set.name, "ntt_forward", variant, poly_bytes, [&] { engine.ntt_forward_avx(x); });
+        reporter.run(set.name, "ntt_inverse", variant, poly_bytes, [&] { engine.ntt_inverse_avx(x); });
+        reporter.run(set.name, "pointwise", variant, 2 * poly_bytes,
+                     [&] { engine.pointwise_multiply_avx(x, y, r); });
+    }
+}
+
+void benchmark_sampling(Reporter& reporter, const ParameterSet& set) {
+    const uint32_t n = set.params.degree;
+    const uint32_t q = set.params.modulus;
+    const uint32_t k = set.params.module_rank;
+    const size_t poly_bytes = n * sizeof(uint32_t);
+    std::array<uint8_t, 32> seed;
+    for (size_t i = 0; i < seed.size(); ++i) seed[i] = static_cast<uint8_t>(i * 7 + 3);
+
+    std::vector<uint32_t> coeffs(n);
+    SHAKE256Sampler sampler;
+    sampler.init(seed.data(), seed.size());
+    reporter.run(set.name, "sample_cbd", "shake256", poly_bytes,
+                 [&] { sampler.sample_polynomial_binomial(coeffs.data(), n, set.params.eta, q); });
+    reporter.run(set.name, "sample_uniform", "shake256", poly_bytes,
+                 [&] { sampler.sample_polynomial_uniform(coeffs.data(), n, q); });
+
+    AVXNTTEngine engine(q, n);
+    RingOperations ring(set.params, &engine);
+    reporter.run(set.name, "sample_cbd", "ring", poly_bytes,
+                 [&] { AVXPolynomial p = ring.sample_binomial(set.params.eta, seed); });
+    reporter.run(set.name, "expand_matrix", "ring", static_cast<size_t>(k) * k * poly_bytes,
+                 [&] { auto A = ring.generate_matrix_A(seed); });
+}
+
+void benchmark_packing(Reporter& reporter, const ParameterSet& set) {
+    const uint32_t n = set.params.degree;
+    const uint32_t q = set.params.modulus;
+    const uint32_t bits = coefficient_bits(q);
+    const size_t packed = packed_poly_bytes(n, bits);
+    const std::string variant = std::to_string(bits) + "-bit";
+
+    AVXPolynomial poly(n, q);
+    poly.copy_from(random_coeffs(n, q, 3).data());
+    std::vector<uint8_t> buffer(packed);
+    reporter.run(set.name, "pack", variant, packed, [&] { pack_poly(poly, bits, buffer.data()); });
+    reporter.run(set.name, "unpack", variant, packed, [&] { unpack_poly(buffer.data(), bits, poly); });
+}
+
+void benchmark_colors(Reporter& reporter, const ParameterSet& set) {
+    const uint32_t n = set.params.degree;
+    const uint32_t q = set.params.modulus;
+    const size_t poly_bytes = n * sizeof(uint32_t);
+
+    ColorNTTEngine engine(q, n);
+    std::vector<uint32_t> coeffs = random_coeffs(n, q, 4);
+    std::vector<ColorValue> colors(n);
+    reporter.run(set.name, "to_colors", "color-engine", poly_bytes,
+                 [&] { engine.convert_uint32_to_colors(coeffs.data(), colors.data()); });
+    reporter.run(set.name, "from_colors", "color-engine", poly_bytes,
+                 [&] { engine.convert_colors_to_uint32(colors.data(), coeffs.data()); });
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            if (!bench::parse_int(argv[++i], size_t(1), options.samples)) return false;
+        } else if (arg == "--csv") {
+            options.csv = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--filter TEXT] [--samples N] [--csv]" << std::endl;
+        return 2;
+    }
+
+    if (!options.csv) {
+        std::cout << "CLWE Kernel Benchmark" << std::endl;
+        std::cout << "=====================" << std::endl;
+        std::cout << "CPU: " << CPUFeatureDetector::cached().to_string() << std::endl;
+        std::cout << "Kernels: " << selected_kernels().to_string() << std::endl;
+        std::cout << "Cycle counter: " << std::fixed << std::setprecision(0)
+                  << cycle_counter_frequency() / 1e6 << " MHz" << std::endl;
+        std::cout << std::endl;
+    }
+
+    std::vector<ParameterSet> sets;
+    for (uint32_t level : {128u, 192u, 256u}) {
+        sets.push_back({"kem-" + std::to_string(level), clwe::CLWEParameters(level)});
+    }
+    // Signature modulus; matrix expansion uses the k of the 128-bit level
+    clwe::CLWEParameters sign_params(128);
+    sign_params.modulus = SIGN_MODULUS;
+    sign_params.module_rank = SignParameters::for_security_level(128).k;
+    sign_params.eta = SignParameters::for_security_level(128).eta;
+    sets.push_back({"sign-128", sign_params});
+
+    Reporter reporter(options);
+    for (const ParameterSet& set : sets) {
+        benchmark_ntt(reporter, set);
+        benchmark_sampling(reporter, set);
+        benchmark_packing(reporter, set);
+        benchmark_colors(reporter, set);
+    }
+    return 0;
+}
@@ -0,0 +1,340 @@
+#ifndef BENCHMARK_SUPPORT_HPP
+#define BENCHMARK_SUPPORT_HPP
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#define BENCH_HAVE_CLFLUSH
+#endif
+
+// Helpers shared by the benchmark executables.
+
+namespace bench {
+
+// HDR-style latency histogram. Values below 2^SUB_BITS ns are exact; each
+// power-of-two range above is split into 2^SUB_BITS linear buckets, which
+// bounds the relative error of any reported percentile by 2^-SUB_BITS.
+class LatencyHistogram {
+private:
+    static constexpr uint32_t SUB_BITS = 7;
+    static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t min_ = 0;
+    uint64_t max_ = 0;
+    double sum_ = 0;
+
+    static uint32_t magnitude(uint64_t value) {
+        uint32_t m = 0;
+        while (value >> (m + 1)) ++m;
+        return m;
+    }
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < SUB_COUNT) return static_cast<size_t>(value);
+        uint32_t shift = magnitude(value) - SUB_BITS;
+        return static_cast<size_t>(SUB_COUNT * (shift + 1) + ((value >> shift) - SUB_COUNT));
+    }
+
+    // Midpoint of the values that share a bucket
+    static uint64_t bucket_value(size_t index) {
+        if (index < SUB_COUNT) return index;
+        uint32_t shift = static_cast<uint32_t>(index / SUB_COUNT) - 1;
+        uint64_t low = (SUB_COUNT + index % SUB_COUNT) << shift;
+        return low + ((1ull << shift) >> 1);
+    }
+
+public:
+    LatencyHistogram() : counts_(SUB_COUNT * (64 - SUB_BITS + 1), 0) {}
+
+    void record(uint64_t ns) {
+        counts_[bucket_index(ns)]++;
+        if (total_ == 0 || ns < min_) min_ = ns;
+        if (ns > max_) max_ = ns;
+        sum_ += static_cast<double>(ns);
+        total_++;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        if (other.total_ == 0) return;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        if (total_ == 0 || other.min_ < min_) min_ = other.min_;
+        if (other.max_ > max_) max_ = other.max_;
+        sum_ += other.sum_;
+        total_ += other.total_;
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return min_; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? sum_ / total_ : 0.0; }
+
+    uint64_t percentile(double pct) const {
+        if (total_ == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(pct / 100.0 * total_ + 0.999999);
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(std::max(bucket_value(i), min_), max_);
+        }
+        return max_;
+    }
+};
+
+// Pins the calling thread to one CPU; false where unsupported or refused
+inline bool pin_to_cpu(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// CPUs the calling thread may run on, in ascending id order. Ids need not
+// be contiguous (offline CPUs, taskset, cgroup cpusets); where the affinity
+// mask is unavailable this is 0 .. fallback_count - 1.
+inline std::vector<int> allowed_cpus(int fallback_count) {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        for (int cpu = 0; cpu < std::max(1, fallback_count); ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+inline double to_us(double ns) {
+    return ns / 1000.0;
+}
+
+// Strict command-line integer: the whole of text in base 10, at least
+// minimum and representable in T
+template<typename T>
+bool parse_int(const char* text, T minimum, T& value) {
+    static_assert(std::is_integral<T>::value, "parse_int needs an integer type");
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE) return false;
+    if (parsed < static_cast<long long>(minimum)) return false;
+    if (parsed > 0 && static_cast<unsigned long long>(parsed) > std::numeric_limits<T>::max()) return false;
+    value = static_cast<T>(parsed);
+    return true;
+}
+
+constexpr bool cache_flush_supported() {
+#if defined(BENCH_HAVE_CLFLUSH) || defined(__aarch64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Writes back and evicts [data, data + bytes) from every cache level
+// (clflush, or dc civac on AArch64); a no-op where unsupported. Steps by
+// 64 bytes, the smallest line size on those targets.
+inline void flush_cache_lines(const void* data, size_t bytes) {
+    const uintptr_t end = reinterpret_cast<uintptr_t>(data) + bytes;
+    for (uintptr_t line = reinterpret_cast<uintptr_t>(data) & ~uintptr_t(63); line < end; line += 64) {
+#if defined(BENCH_HAVE_CLFLUSH)
+        _mm_clflush(reinterpret_cast<const void*>(line));
+#elif defined(__aarch64__)
+        asm volatile("dc civac, %0" : : "r"(line) : "memory");
+#endif
+    }
+}
+
+// Orders earlier flush_cache_lines() calls before later memory accesses
+inline void flush_fence() {
+#if defined(BENCH_HAVE_CLFLUSH)
+    _mm_mfence();
+#elif defined(__aarch64__)
+    asm volatile("dsb ish" : : : "memory");
+#endif
+}
+
+// Hardware counters read through perf_event_open (Linux)
+enum class PerfEvent : uint32_t {
+    Cycles,
+    Instructions,
+    L1DMisses,
+    LLCMisses,
+    BranchMisses,
+    Count
+};
+
+constexpr size_t PERF_EVENT_COUNT = static_cast<size_t>(PerfEvent::Count);
+
+inline const char* perf_event_name(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::L1DMisses: return "l1d_misses";
+        case PerfEvent::LLCMisses: return "llc_misses";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        default: return "unknown";
+    }
+}
+
+// Counter totals for one measured region; an event that could not be opened
+// or never ran is marked invalid
+struct PerfSample {
+    std::array<double, PERF_EVENT_COUNT> values{};
+    std::array<bool, PERF_EVENT_COUNT> valid{};
+
+    bool has(PerfEvent event) const { return valid[static_cast<size_t>(event)]; }
+    double operator[](PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+
+    bool any() const {
+        return std::find(valid.begin(), valid.end(), true) != valid.end();
+    }
+};
+
+// Counts user-space events of the calling thread between start() and stop().
+// Each event is opened on its own, so an event the PMU or
+// perf_event_paranoid refuses only drops that column. Counts are scaled up
+// when the kernel multiplexes counters.
+class PerfCounters {
+private:
+    std::array<int, PERF_EVENT_COUNT> fds_;
+    std::string error_;
+
+#ifdef __linux__
+    static int open_event(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static uint64_t cache_config(uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+#endif
+
+public:
+    PerfCounters() {
+        fds_.fill(-1);
+#ifdef __linux__
+        const std::array<std::pair<uint32_t, uint64_t>, PERF_EVENT_COUNT> events = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        }};
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            fds_[i] = open_event(events[i].first, events[i].second);
+            if (fds_[i] < 0 && error_.empty()) {
+                error_ = std::string(perf_event_name(static_cast<PerfEvent>(i))) + ": " + std::strerror(errno);
+            }
+        }
+#else
+        error_ = "perf_event_open is only available on Linux";
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const {
+        return std::any_of(fds_.begin(), fds_.end(), [](int fd) { return fd >= 0; });
+    }
+
+    // First event that failed to open, or empty
+    const std::string& error() const { return error_; }
+
+    void start() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Excludes work between pause() and resume() from a started region
+    void pause() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    void resume() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    PerfSample stop() {
+        PerfSample sample;
+#ifdef __linux__
+        pause();
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            uint64_t data[3];   // value, time enabled, time running
+            if (fds_[i] < 0 || read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+            if (data[2] == 0) continue;
+            sample.values[i] = static_cast<double>(data[0]) * data[1] / data[2];
+            sample.valid[i] = true;
+        }
+#endif
+        return sample;
+    }
+};
+
+} // namespace bench
+
+#endif // BENCHMARK_SUPPORT_HPP
@@ -0,0 +1,307 @@
+#include "autotune.hpp"
+#include "cpu_features.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+namespace clwe {
+
+namespace {
+
+constexpr const char* CACHE_HEADER = "# clwe autotune v1";
+// Timed rounds per candidate; the fastest round counts
+constexpr int TIMING_ROUNDS = 9;
+// Iterations per round grow until one round takes this long
+constexpr double MIN_ROUND_NS = 50000.0;
+
+constexpr int UNSET = -1;
+std::atomic<int> api_enabled{UNSET};
+
+struct TunerState {
+    std::mutex mutex;
+    std::string cache_path;   // API override; empty uses the environment
+    std::map<std::string, EngineConfig> tuned;   // By cache key
+};
+
+TunerState& state() {
+    static TunerState instance;
+    return instance;
+}
+
+bool environment_enabled() {
+    static const bool enabled = [] {
+        const char* value = std::getenv("CLWE_AUTOTUNE");
+        if (!value) return false;
+        std::string v(value);
+        return v == "1" || v == "true" || v == "on" || v == "yes";
+    }();
+    return enabled;
+}
+
+std::string default_cache_path() {
+    if (const char* path = std::getenv("CLWE_AUTOTUNE_CACHE")) {
+        if (*path) return path;
+    }
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+        if (*xdg) return std::string(xdg) + "/clwe/autotune.txt";
+    }
+    if (const char* home = std::getenv("HOME")) {
+        if (*home) return std::string(home) + "/.cache/clwe/autotune.txt";
+    }
+    return std::string();
+}
+
+bool parse_strategy(const std::string& name, ReductionStrategy& strategy) {
+    for (ReductionStrategy candidate : {ReductionStrategy::Montgomery, ReductionStrategy::Barrett,
+                                        ReductionStrategy::Shoup, ReductionStrategy::SpecialForm}) {
+        if (name == reduction_strategy_name(candidate)) {
+            strategy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool strategy_allowed(ReductionStrategy strategy, uint32_t q) {
+    switch (strategy) {
+        case ReductionStrategy::Montgomery: return true;
+        case ReductionStrategy::SpecialForm: return q < (1u << 30) && has_special_form_kernel(q);
+        default: return q < (1u << 30);
+    }
+}
+
+// Cache lines: model, build tier, tier cap, q, n, strategy, tier, nanoseconds (tab separated)
+std::string cache_key(uint32_t q, uint32_t n) {
+    const std::string& model = CPUFeatureDetector::cached().model_name;
+    std::ostringstream key;
+    key << (model.empty() ? "unknown" : model) << '\t' << kernel_tier_name(compiled_kernel_tier()) << '\t'
+        << kernel_tier_name(active_kernel_tier()) << '\t' << q << '\t' << n;
+    return key.str();
+}
+
+// Splits off the first five fields; returns false for comments and malformed lines
+bool split_line(const std::string& line, std::string& key, std::vector<std::string>& rest) {
+    if (line.empty() || line[0] == '#') return false;
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, '\t')) {
+        fields.push_back(field);
+    }
+    if (fields.size() != 8) return false;
+    key = fields[0] + '\t' + fields[1] + '\t' + fields[2] + '\t' + fields[3] + '\t' + fields[4];
+    rest.assign(fields.begin() + 5, fields.end());
+    return true;
+}
+
+bool load_cached(const std::string& path, const std::string& key, uint32_t q, EngineConfig& config) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string line_key;
+        std::vector<std::string> rest;
+        if (!split_line(line, line_key, rest) || line_key != key) continue;
+
+        EngineConfig cached;
+        if (!parse_strategy(rest[0], cached.strategy) || !parse_kernel_tier(rest[1], cached.tier)) continue;
+        if (!strategy_allowed(cached.strategy, q) || cached.tier > active_kernel_tier()) continue;
+        cached.nanoseconds = std::atof(rest[2].c_str());
+        config = cached;
+        return true;
+    }
+    return false;
+}
+
+// Rewrites the file with this key's line replaced; other processes' entries are kept
+void store_cached(const std::string& path, const std::string& key, const EngineConfig& config) {
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::string line_key;
+            std::vector<std::string> rest;
+            if (split_line(line, line_key, rest) && line_key != key) {
+                lines.push_back(line);
+            }
+        }
+    }
+    std::ostringstream entry;
+    entry << key << '\t' << reduction_strategy_name(config.strategy) << '\t'
+          << kernel_tier_name(config.tier) << '\t' << static_cast<uint64_t>(config.nanoseconds);
+    lines.push_back(entry.str());
+
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+    // Write then rename, so a concurrent reader never sees a partial file. The
+    // temp name is unique per writer, so concurrent writers never share one;
+    // the last rename wins and the other's new entry is re-tuned next time.
+    std::random_device rd;
+    std::ostringstream temp_name;
+    temp_name << path << ".tmp." << std::hex << rd() << rd();
+    const std::string temp = temp_name.str();
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        if (!out) return;
+        out << CACHE_HEADER << '\n';
+        for (const std::string& line : lines) {
+            out << line << '\n';
+        }
+        if (!out) return;
+    }
+    std::filesystem::rename(temp, target, ec);
+    if (ec) std::filesystem::remove(temp, ec);
+}
+
+// Fastest time for one forward + pointwise + inverse round; out receives the
+// product of a and b for the cross-check between candidates
+double time_engine(const AVXNTTEngine& engine, const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+                   std::vector<uint32_t>& out) {
+    const uint32_t n = engine.degree();
+    // 64-byte aligned coefficient buffers viewed as AVX2 lanes
+    AlignedVector<uint32_t> x_buf(n), y_buf(n), r_buf(n);
+    __m256i* x = reinterpret_cast<__m256i*>(x_buf.data());
+    __m256i* y = reinterpret_cast<__m256i*>(y_buf.data());
+    __m256i* r = reinterpret_cast<__m256i*>(r_buf.data());
+    engine.copy_from_uint32(a.data(), x);
+    engine.copy_from_uint32(b.data(), y);
+    engine.ntt_forward_avx(y);
+
+    auto round = [&] {
+        engine.ntt_forward_avx(x);
+        engine.pointwise_multiply_avx(x, y, r);
+        engine.ntt_inverse_avx(r);
+    };
+
+    round();
+    out.resize(n);
+    engine.copy_to_uint32(r, out.data());
+
+    uint32_t iterations = 8;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) round();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= MIN_ROUND_NS || iterations >= (1u << 20)) break;
+        iterations *= 2;
+    }
+
+    double best = 0;
+    for (int t = 0; t < TIMING_ROUNDS; ++t) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) round();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        double per_round = elapsed / iterations;
+        if (t == 0 || per_round < best) best = per_round;
+    }
+    return best;
+}
+
+EngineConfig default_config() {
+    EngineConfig config;
+    config.strategy = ReductionStrategy::Montgomery;
+    config.tier = active_kernel_tier();
+    return config;
+}
+
+} // namespace
+
+void set_autotuning(bool enabled) {
+    api_enabled.store(enabled ? 1 : 0, std::memory_order_relaxed);
+}
+
+bool autotuning_enabled() {
+    int enabled = api_enabled.load(std::memory_order_relaxed);
+    return enabled == UNSET ? environment_enabled() : enabled == 1;
+}
+
+void set_autotune_cache_path(const std::string& path) {
+    TunerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.cache_path = path;
+}
+
+std::string autotune_cache_path() {
+    TunerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.cache_path.empty() ? default_cache_path() : s.cache_path;
+}
+
+std::vector<EngineConfig> benchmark_engine_configs(uint32_t q, uint32_t n) {
+    std::mt19937 rng(q ^ (n << 20));
+    std::vector<uint32_t> a(n), b(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        a[i] = rng() % q;
+        b[i] = rng() % q;
+    }
+
+    std::vector<EngineConfig> results;
+    std::vector<uint32_t> reference, product;
+    const KernelTier top = active_kernel_tier();
+    for (KernelTier tier : {KernelTier::Scalar, KernelTier::AVX2, KernelTier::AVX512}) {
+        if (tier > top) break;
+        for (ReductionStrategy strategy : {ReductionStrategy::Montgomery, ReductionStrategy::Barrett,
+                                           ReductionStrategy::Shoup, ReductionStrategy::SpecialForm}) {
+            if (!strategy_allowed(strategy, q)) continue;
+            AVXNTTEngine engine(q, n, strategy, tier);
+            EngineConfig config;
+            config.strategy = strategy;
+            config.tier = tier;
+            config.nanoseconds = time_engine(engine, a, b, product);
+            // Every configuration must agree; a disagreeing one is never chosen
+            if (reference.empty()) {
+                reference = product;
+            } else if (product != reference) {
+                continue;
+            }
+            results.push_back(config);
+        }
+    }
+    std::stable_sort(results.begin(), results.end(), [](const EngineConfig& x, const EngineConfig& y) {
+        return x.nanoseconds < y.nanoseconds;
+    });
+    return results;
+}
+
+EngineConfig tuned_engine_config(uint32_t q, uint32_t n) {
+    if (!autotuning_enabled()) {
+        return default_config();
+    }
+
+    const std::string path = autotune_cache_path();
+    const std::string key = cache_key(q, n);
+    TunerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto found = s.tuned.find(key);
+    if (found != s.tuned.end()) {
+        return found->second;
+    }
+
+    EngineConfig config;
+    if (path.empty() || !load_cached(path, key, q, config)) {
+        std::vector<EngineConfig> results = benchmark_engine_configs(q, n);
+        config = results.empty() ? default_config() : results.front();
+        if (!path.empty() && !results.empty()) {
+            store_cached(path, key, config);
+        }
+    }
+    s.tuned[key] = config;
+    return config;
+}
+
+std::unique_ptr<AVXNTTEngine> create_tuned_avx_engine(uint32_t q, uint32_t n) {
+    EngineConfig config = tuned_engine_config(q, n);
+    return std::make_unique<AVXNTTEngine>(q, n, config.strategy, config.tier);
+}
+
+} // namespace clwe
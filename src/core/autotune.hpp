@@ -0,0 +1,52 @@
+#ifndef AUTOTUNE_HPP
+#define AUTOTUNE_HPP
+
+#include "ntt_avx.hpp"
+#include "kernel_dispatch.hpp"
+#include "modular_reduction.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clwe {
+
+// Opt-in startup autotuning of AVXNTTEngine configurations.
+//
+// Enabled with set_autotuning(true) or CLWE_AUTOTUNE=1. The first request for
+// a (q, n) pair times a forward NTT, a pointwise product and an inverse NTT
+// for every reduction strategy the modulus admits at every kernel tier up to
+// active_kernel_tier(), and keeps the fastest. The winner is written to a
+// cache file keyed by CPU model, build and tier cap, so later processes on
+// the same machine skip the measurement.
+//
+// The cache file is the set_autotune_cache_path() value, else
+// CLWE_AUTOTUNE_CACHE, else $XDG_CACHE_HOME/clwe/autotune.txt, else
+// $HOME/.cache/clwe/autotune.txt. Failing to read or write it only costs a
+// re-measurement.
+
+struct EngineConfig {
+    ReductionStrategy strategy = ReductionStrategy::Montgomery;
+    KernelTier tier = KernelTier::Scalar;
+    double nanoseconds = 0;   // One forward + pointwise + inverse round; 0 when not measured
+};
+
+void set_autotuning(bool enabled);
+bool autotuning_enabled();
+
+void set_autotune_cache_path(const std::string& path);
+// Empty when no path could be derived
+std::string autotune_cache_path();
+
+// Times every candidate configuration for (q, n) now, fastest first
+std::vector<EngineConfig> benchmark_engine_configs(uint32_t q, uint32_t n);
+
+// Tuned configuration when autotuning is enabled (from this process, the
+// cache file or a fresh measurement); otherwise Montgomery at active_kernel_tier()
+EngineConfig tuned_engine_config(uint32_t q, uint32_t n);
+
+std::unique_ptr<AVXNTTEngine> create_tuned_avx_engine(uint32_t q, uint32_t n);
+
+} // namespace clwe
+
+#endif // AUTOTUNE_HPP
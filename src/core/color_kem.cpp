@@ -1,6 +1,8 @@
 #include "color_kem.hpp"
 #include "shake_sampler.hpp"
 #include "utils.hpp"
+#include "memory_resource.hpp"
+#include "clwe/instrumentation.hpp"
 #include <random>
 #include <cstring>
 #include <algorithm>
@@ -15,25 +17,28 @@ ColorKEM::ColorKEM(const CLWEParameters& params)
 ColorKEM::~ColorKEM() = default;
 
 
-std::vector<std::vector<ColorValue>> ColorKEM::generate_matrix_A(const std::array<uint8_t, 32>& seed) const {
+ColorKEM::ColorMatrix ColorKEM::generate_matrix_A(const std::array<uint8_t, 32>& seed) const {
+    CLWE_INSTRUMENT(MatrixExpansion);
     uint32_t k = params_.module_rank;
     uint32_t n = params_.degree;
     uint32_t q = params_.modulus;
 
-    std::vector<std::vector<ColorValue>> matrix(k, std::vector<ColorValue>(k));
+    ColorMatrix matrix(k, current_memory_resource());
+    for (auto& row : matrix) {
+        row.resize(k);
+    }
 
     
     for (uint32_t i = 0; i < k; ++i) {
         for (uint32_t j = 0; j < k; ++j) {
             
-            std::vector<uint32_t> coeffs(n);
+            std::pmr::vector<uint32_t> coeffs(n, current_memory_resource());
 
             
-            std::vector<uint8_t> shake_input;
-            shake_input.reserve(seed.size() + 2);
-            shake_input.insert(shake_input.end(), seed.begin(), seed.end());
-            shake_input.push_back(static_cast<uint8_t>(i));
-            shake_input.push_back(static_cast<uint8_t>(j));
+            std::array<uint8_t, 34> shake_input;
+            std::copy(seed.begin(), seed.end(), shake_input.begin());
+            shake_input[32] = static_cast<uint8_t>(i);
+            shake_input[33] = static_cast<uint8_t>(j);
 
             
             SHAKE128Sampler shake128;
@@ -68,8 +73,9 @@ std::vector<std::vector<ColorValue>> ColorKEM::generate_matrix_A(const std::arra
 }
 
 
-std::vector<ColorValue> ColorKEM::generate_error_vector() const {
-    std::vector<ColorValue> error_vector(params_.module_rank);
+ColorKEM::ColorVector ColorKEM::generate_error_vector() const {
+    CLWE_INSTRUMENT(Sampling);
+    ColorVector error_vector(params_.module_rank, current_memory_resource());
 
     
     SHAKE256Sampler sampler;
@@ -89,8 +95,9 @@ std::vector<ColorValue> ColorKEM::generate_error_vector() const {
 }
 
 
-std::vector<ColorValue> ColorKEM::generate_secret_key() const {
-    std::vector<ColorValue> secret_key(params_.module_rank);
+ColorKEM::ColorVector ColorKEM::generate_secret_key() const {
+    CLWE_INSTRUMENT(Sampling);
+    ColorVector secret_key(params_.module_rank, current_memory_resource());
 
     
     SHAKE256Sampler sampler;
@@ -110,12 +117,12 @@ std::vector<ColorValue> ColorKEM::generate_secret_key() const {
 }
 
 
-std::vector<ColorValue> ColorKEM::generate_public_key(const std::vector<ColorValue>& secret_key,
-                                                    const std::vector<std::vector<ColorValue>>& matrix_A,
-                                                    const std::vector<ColorValue>& error_vector) const {
+ColorKEM::ColorVector ColorKEM::generate_public_key(const ColorVector& secret_key,
+                                                  const ColorMatrix& matrix_A,
+                                                  const ColorVector& error_vector) const {
     
     auto As = this->matrix_vector_mul(matrix_A, secret_key);
-    std::vector<ColorValue> public_key(params_.module_rank);
+    ColorVector public_key(params_.module_rank, current_memory_resource());
 
     for (uint32_t i = 0; i < params_.module_rank; ++i) {
         
@@ -129,10 +136,10 @@ std::vector<ColorValue> ColorKEM::generate_public_key(const std::vector<ColorVal
 }
 
 
-std::vector<ColorValue> ColorKEM::matrix_vector_mul(const std::vector<std::vector<ColorValue>>& matrix,
-                                                  const std::vector<ColorValue>& vector) const {
+ColorKEM::ColorVector ColorKEM::matrix_vector_mul(const ColorMatrix& matrix,
+                                                const ColorVector& vector) const {
     uint32_t k = params_.module_rank;
-    std::vector<ColorValue> result(k);
+    ColorVector result(k, current_memory_resource());
 
     for (uint32_t i = 0; i < k; ++i) {
         uint64_t sum = 0;
@@ -148,10 +155,10 @@ std::vector<ColorValue> ColorKEM::matrix_vector_mul(const std::vector<std::vecto
 }
 
 
-std::vector<ColorValue> ColorKEM::matrix_transpose_vector_mul(const std::vector<std::vector<ColorValue>>& matrix,
-                                                            const std::vector<ColorValue>& vector) const {
+ColorKEM::ColorVector ColorKEM::matrix_transpose_vector_mul(const ColorMatrix& matrix,
+                                                          const ColorVector& vector) const {
     uint32_t k = params_.module_rank;
-    std::vector<ColorValue> result(k);
+    ColorVector result(k, current_memory_resource());
 
     for (uint32_t i = 0; i < k; ++i) {
         uint64_t sum = 0;
@@ -168,8 +175,8 @@ std::vector<ColorValue> ColorKEM::matrix_transpose_vector_mul(const std::vector<
 
 
 
-ColorValue ColorKEM::decrypt_message(const std::vector<ColorValue>& secret_key,
-                                    const std::vector<ColorValue>& ciphertext) const {
+ColorValue ColorKEM::decrypt_message(const ColorVector& secret_key,
+                                    const ColorVector& ciphertext) const {
     
     
 
@@ -177,7 +184,7 @@ ColorValue ColorKEM::decrypt_message(const std::vector<ColorValue>& secret_key,
     uint32_t q = params_.modulus;
 
     
-    std::vector<ColorValue> c1(ciphertext.begin(), ciphertext.begin() + k);
+    ColorVector c1(ciphertext.begin(), ciphertext.begin() + k, current_memory_resource());
     ColorValue c2 = ciphertext[k];
 
     
@@ -234,7 +241,9 @@ ColorValue ColorKEM::decode_color_secret(const std::vector<uint8_t>& encoded) co
 }
 
 
-std::pair<ColorKEM::ColorPublicKey, ColorKEM::ColorPrivateKey> ColorKEM::keygen() {
+std::pair<ColorKEM::ColorPublicKey, ColorKEM::ColorPrivateKey> ColorKEM::keygen(std::pmr::memory_resource* resource) {
+    CLWE_INSTRUMENT(KeyGen);
+    ScopedMemoryResource scope(resource);
     
     std::array<uint8_t, 32> matrix_seed;
     std::random_device rd;
@@ -253,17 +262,8 @@ std::pair<ColorKEM::ColorPublicKey, ColorKEM::ColorPrivateKey> ColorKEM::keygen(
     auto public_key_colors = generate_public_key(secret_key_colors, matrix_A, error_vector);
 
     
-    std::vector<uint8_t> secret_data;
-    for (const auto& color : secret_key_colors) {
-        auto bytes = color_secret_to_bytes(color);
-        secret_data.insert(secret_data.end(), bytes.begin(), bytes.end());
-    }
-
-    std::vector<uint8_t> public_data;
-    for (const auto& color : public_key_colors) {
-        auto bytes = color_secret_to_bytes(color);
-        public_data.insert(public_data.end(), bytes.begin(), bytes.end());
-    }
+    std::vector<uint8_t> secret_data = encode_colors(secret_key_colors);
+    std::vector<uint8_t> public_data = encode_colors(public_key_colors);
 
     ColorPublicKey public_key{matrix_seed, public_data, params_};
     ColorPrivateKey private_key{secret_data, params_};
@@ -272,7 +272,10 @@ std::pair<ColorKEM::ColorPublicKey, ColorKEM::ColorPrivateKey> ColorKEM::keygen(
 }
 
 
-std::pair<ColorKEM::ColorCiphertext, ColorValue> ColorKEM::encapsulate(const ColorPublicKey& public_key) {
+std::pair<ColorKEM::ColorCiphertext, ColorValue> ColorKEM::encapsulate(const ColorPublicKey& public_key,
+                                                                      std::pmr::memory_resource* resource) {
+    CLWE_INSTRUMENT(Encapsulate);
+    ScopedMemoryResource scope(resource);
     
     ColorValue shared_secret = ColorValue::from_precise_value(rand() % 2);  
 
@@ -280,22 +283,13 @@ std::pair<ColorKEM::ColorCiphertext, ColorValue> ColorKEM::encapsulate(const Col
     auto matrix_A = generate_matrix_A(public_key.seed);
 
     
-    std::vector<ColorValue> public_key_colors;
-    for (size_t i = 0; i < public_key.public_data.size(); i += 4) {
-        std::vector<uint8_t> bytes(public_key.public_data.begin() + i,
-                                  public_key.public_data.begin() + std::min(i + 4, public_key.public_data.size()));
-        public_key_colors.push_back(bytes_to_color_secret(bytes));
-    }
+    ColorVector public_key_colors = decode_colors(public_key.public_data);
 
     
     auto ciphertext_colors = encrypt_message(matrix_A, public_key_colors, shared_secret);
 
     
-    std::vector<uint8_t> ciphertext_data;
-    for (const auto& color : ciphertext_colors) {
-        auto bytes = color_secret_to_bytes(color);
-        ciphertext_data.insert(ciphertext_data.end(), bytes.begin(), bytes.end());
-    }
+    std::vector<uint8_t> ciphertext_data = encode_colors(ciphertext_colors);
 
     
     auto shared_secret_hint = encode_color_secret(shared_secret);
@@ -308,22 +302,13 @@ std::pair<ColorKEM::ColorCiphertext, ColorValue> ColorKEM::encapsulate(const Col
 
 ColorValue ColorKEM::decapsulate(const ColorPublicKey& public_key,
                                 const ColorPrivateKey& private_key,
-                                const ColorCiphertext& ciphertext) {
-    
-    std::vector<ColorValue> secret_key_colors;
-    for (size_t i = 0; i < private_key.secret_data.size(); i += 4) {
-        std::vector<uint8_t> bytes(private_key.secret_data.begin() + i,
-                                  private_key.secret_data.begin() + std::min(i + 4, private_key.secret_data.size()));
-        secret_key_colors.push_back(bytes_to_color_secret(bytes));
-    }
+                                const ColorCiphertext& ciphertext,
+                                std::pmr::memory_resource* resource) {
+    CLWE_INSTRUMENT(Decapsulate);
+    ScopedMemoryResource scope(resource);
 
-    
-    std::vector<ColorValue> ciphertext_colors;
-    for (size_t i = 0; i < ciphertext.ciphertext_data.size(); i += 4) {
-        std::vector<uint8_t> bytes(ciphertext.ciphertext_data.begin() + i,
-                                  ciphertext.ciphertext_data.begin() + std::min(i + 4, ciphertext.ciphertext_data.size()));
-        ciphertext_colors.push_back(bytes_to_color_secret(bytes));
-    }
+    ColorVector secret_key_colors = decode_colors(private_key.secret_data);
+    ColorVector ciphertext_colors = decode_colors(ciphertext.ciphertext_data);
 
     
     ColorValue recovered_secret = decrypt_message(secret_key_colors, ciphertext_colors);
@@ -360,8 +345,40 @@ ColorValue ColorKEM::bytes_to_color_secret(const std::vector<uint8_t>& bytes) {
     return ColorValue::from_precise_value(value);
 }
 
+ColorKEM::ColorVector ColorKEM::decode_colors(const std::vector<uint8_t>& data) const {
+    ColorVector colors(current_memory_resource());
+    colors.reserve((data.size() + 3) / 4);
+    for (size_t i = 0; i < data.size(); i += 4) {
+        if (i + 4 > data.size()) {
+            // Short trailing chunk decodes to zero, as bytes_to_color_secret
+            colors.push_back(ColorValue::from_precise_value(0));
+            break;
+        }
+        uint32_t value = (static_cast<uint32_t>(data[i]) << 24) |
+                        (static_cast<uint32_t>(data[i + 1]) << 16) |
+                        (static_cast<uint32_t>(data[i + 2]) << 8) |
+                        static_cast<uint32_t>(data[i + 3]);
+        colors.push_back(ColorValue::from_precise_value(value));
+    }
+    return colors;
+}
+
+std::vector<uint8_t> ColorKEM::encode_colors(const ColorVector& colors) {
+    std::vector<uint8_t> data;
+    data.reserve(colors.size() * 4);
+    for (const auto& color : colors) {
+        uint32_t value = static_cast<uint32_t>(color.to_precise_value());
+        data.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+        data.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
+        data.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+        data.push_back(static_cast<uint8_t>(value & 0xFF));
+    }
+    return data;
+}
+
 
 std::vector<uint8_t> ColorKEM::ColorPublicKey::serialize() const {
+    CLWE_INSTRUMENT(Serialization);
     std::vector<uint8_t> data;
     
     data.insert(data.end(), seed.begin(), seed.end());
@@ -371,6 +388,7 @@ std::vector<uint8_t> ColorKEM::ColorPublicKey::serialize() const {
 }
 
 ColorKEM::ColorPublicKey ColorKEM::ColorPublicKey::deserialize(const std::vector<uint8_t>& data) {
+    CLWE_INSTRUMENT(Deserialization);
     ColorPublicKey key;
     if (data.size() >= 32) {
         std::copy(data.begin(), data.begin() + 32, key.seed.begin());
@@ -380,16 +398,19 @@ ColorKEM::ColorPublicKey ColorKEM::ColorPublicKey::deserialize(const std::vector
 }
 
 std::vector<uint8_t> ColorKEM::ColorPrivateKey::serialize() const {
+    CLWE_INSTRUMENT(Serialization);
     return secret_data;
 }
 
 ColorKEM::ColorPrivateKey ColorKEM::ColorPrivateKey::deserialize(const std::vector<uint8_t>& data) {
+    CLWE_INSTRUMENT(Deserialization);
     ColorPrivateKey key;
     key.secret_data = data;
     return key;
 }
 
 std::vector<uint8_t> ColorKEM::ColorCiphertext::serialize() const {
+    CLWE_INSTRUMENT(Serialization);
     std::vector<uint8_t> data;
     data.insert(data.end(), ciphertext_data.begin(), ciphertext_data.end());
     data.insert(data.end(), shared_secret_hint.begin(), shared_secret_hint.end());
@@ -397,6 +418,7 @@ std::vector<uint8_t> ColorKEM::ColorCiphertext::serialize() const {
 }
 
 ColorKEM::ColorCiphertext ColorKEM::ColorCiphertext::deserialize(const std::vector<uint8_t>& data) {
+    CLWE_INSTRUMENT(Deserialization);
     ColorCiphertext ct;
     
     size_t split = data.size() / 2;
@@ -406,11 +428,11 @@ ColorKEM::ColorCiphertext ColorKEM::ColorCiphertext::deserialize(const std::vect
 }
 
 
-std::vector<ColorValue> ColorKEM::encrypt_message(const std::vector<std::vector<ColorValue>>& matrix_A,
-                                                const std::vector<ColorValue>& public_key,
-                                                const ColorValue& message) const {
+ColorKEM::ColorVector ColorKEM::encrypt_message(const ColorMatrix& matrix_A,
+                                              const ColorVector& public_key,
+                                              const ColorValue& message) const {
     
-    std::vector<ColorValue> ciphertext(params_.module_rank + 1);
+    ColorVector ciphertext(params_.module_rank + 1, current_memory_resource());
 
     
     auto r_vector = generate_secret_key();
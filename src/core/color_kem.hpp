@@ -6,6 +6,7 @@
 #include "clwe/clwe.hpp"
 #include <vector>
 #include <array>
+#include <memory_resource>
 
 namespace clwe {
 
@@ -40,27 +41,35 @@ private:
         static ColorCiphertext deserialize(const std::vector<uint8_t>& data);
     };
 
-    std::vector<std::vector<ColorValue>> generate_matrix_A(const std::array<uint8_t, 32>& seed) const;
-    std::vector<ColorValue> generate_secret_key() const;
-    std::vector<ColorValue> generate_error_vector() const;
-    std::vector<ColorValue> generate_public_key(const std::vector<ColorValue>& secret_key,
-                                               const std::vector<std::vector<ColorValue>>& matrix_A,
-                                               const std::vector<ColorValue>& error_vector) const;
-    std::vector<ColorValue> encrypt_message(const std::vector<std::vector<ColorValue>>& matrix_A,
-                                          const std::vector<ColorValue>& public_key,
-                                          const ColorValue& message) const;
-    ColorValue decrypt_message(const std::vector<ColorValue>& secret_key,
-                             const std::vector<ColorValue>& ciphertext) const;
-
-    std::vector<ColorValue> matrix_vector_mul(const std::vector<std::vector<ColorValue>>& matrix,
-                                            const std::vector<ColorValue>& vector) const;
-    std::vector<ColorValue> matrix_transpose_vector_mul(const std::vector<std::vector<ColorValue>>& matrix,
-                                                      const std::vector<ColorValue>& vector) const;
+    // Scratch vectors draw from current_memory_resource()
+    using ColorVector = std::pmr::vector<ColorValue>;
+    using ColorMatrix = std::pmr::vector<ColorVector>;
+
+    ColorMatrix generate_matrix_A(const std::array<uint8_t, 32>& seed) const;
+    ColorVector generate_secret_key() const;
+    ColorVector generate_error_vector() const;
+    ColorVector generate_public_key(const ColorVector& secret_key,
+                                    const ColorMatrix& matrix_A,
+                                    const ColorVector& error_vector) const;
+    ColorVector encrypt_message(const ColorMatrix& matrix_A,
+                                const ColorVector& public_key,
+                                const ColorValue& message) const;
+    ColorValue decrypt_message(const ColorVector& secret_key,
+                               const ColorVector& ciphertext) const;
+
+    ColorVector matrix_vector_mul(const ColorMatrix& matrix,
+                                  const ColorVector& vector) const;
+    ColorVector matrix_transpose_vector_mul(const ColorMatrix& matrix,
+                                            const ColorVector& vector) const;
 
     ColorValue generate_shared_secret() const;
     std::vector<uint8_t> encode_color_secret(const ColorValue& secret) const;
     ColorValue decode_color_secret(const std::vector<uint8_t>& encoded) const;
 
+    // 4-byte big-endian color encodings, as color_secret_to_bytes
+    ColorVector decode_colors(const std::vector<uint8_t>& data) const;
+    static std::vector<uint8_t> encode_colors(const ColorVector& colors);
+
 public:
     ColorKEM(const CLWEParameters& params = CLWEParameters());
     ~ColorKEM();
@@ -68,13 +77,18 @@ public:
     ColorKEM(const ColorKEM&) = delete;
     ColorKEM& operator=(const ColorKEM&) = delete;
 
-    std::pair<ColorPublicKey, ColorPrivateKey> keygen();
+    // Scratch allocations come from `resource` (nullptr: current_memory_resource()),
+    // so a per-call monotonic_buffer_resource can drop them in one release.
+    // Returned keys, ciphertexts and secrets never reference it.
+    std::pair<ColorPublicKey, ColorPrivateKey> keygen(std::pmr::memory_resource* resource = nullptr);
 
-    std::pair<ColorCiphertext, ColorValue> encapsulate(const ColorPublicKey& public_key);
+    std::pair<ColorCiphertext, ColorValue> encapsulate(const ColorPublicKey& public_key,
+                                                      std::pmr::memory_resource* resource = nullptr);
 
     ColorValue decapsulate(const ColorPublicKey& public_key,
                           const ColorPrivateKey& private_key,
-                          const ColorCiphertext& ciphertext);
+                          const ColorCiphertext& ciphertext,
+                          std::pmr::memory_resource* resource = nullptr);
 
     bool verify_keypair(const ColorPublicKey& public_key, const ColorPrivateKey& private_key) const;
 
@@ -1,7 +1,15 @@
 #include "cpu_features.hpp"
+#include <algorithm>
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <set>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #ifdef _MSC_VER
 #include <intrin.h>
@@ -31,27 +39,70 @@ std::string CPUFeatures::to_string() const {
         default: ss << "None"; break;
     }
 
+    const CPUTopology& t = topology;
+    if (t.l1d_cache_size || t.l2_cache_size || t.l3_cache_size) {
+        ss << ", L1d/L2/L3: " << t.l1d_cache_size / 1024 << "K/" << t.l2_cache_size / 1024 << "K/"
+           << t.l3_cache_size / 1024 << "K";
+    }
+    if (t.cache_line_size) {
+        ss << ", line: " << t.cache_line_size << "B";
+    }
+    if (t.logical_cores) {
+        ss << ", cores: " << t.physical_cores << " physical / " << t.logical_cores << " logical";
+    }
+
     return ss.str();
 }
 
+uint32_t CPUTopology::default_thread_count() const {
+    if (physical_cores) return physical_cores;
+    if (logical_cores) return logical_cores;
+    return 1;
+}
+
+size_t CPUTopology::items_per_cache(size_t item_bytes, uint32_t level) const {
+    // Conservative sizes for caches the platform did not report
+    uint32_t size;
+    switch (level) {
+        case 1: size = l1d_cache_size ? l1d_cache_size : 32 * 1024; break;
+        case 2: size = l2_cache_size ? l2_cache_size : 256 * 1024; break;
+        default: size = l3_cache_size ? l3_cache_size : 2 * 1024 * 1024; break;
+    }
+    if (item_bytes == 0) return 1;
+    return std::max<size_t>(1, (size / 2) / item_bytes);
+}
+
 CPUFeatures CPUFeatureDetector::detect() {
     CPUArchitecture arch = detect_architecture();
+    CPUFeatures features;
 
     switch (arch) {
         case CPUArchitecture::X86_64:
-            return detect_x86();
+            features = detect_x86();
+            break;
         case CPUArchitecture::ARM64:
-            return detect_arm();
+            features = detect_arm();
+            break;
         case CPUArchitecture::RISCV64:
-            return detect_riscv();
+            features = detect_riscv();
+            break;
         case CPUArchitecture::PPC64:
-            return detect_ppc();
+            features = detect_ppc();
+            break;
         default:
-            CPUFeatures features;
             features.architecture = CPUArchitecture::UNKNOWN;
             features.max_simd_support = SIMDSupport::NONE;
-            return features;
+            break;
     }
+
+    features.model_name = detect_model_name();
+    detect_topology(features.topology);
+    return features;
+}
+
+const CPUFeatures& CPUFeatureDetector::cached() {
+    static const CPUFeatures features = detect();
+    return features;
 }
 
 CPUArchitecture CPUFeatureDetector::detect_architecture() {
@@ -164,6 +215,237 @@ CPUFeatures CPUFeatureDetector::detect_ppc() {
     return features;
 }
 
+namespace {
+
+// Parses sysfs CPU lists such as "0-3,8,10-11"
+std::vector<uint32_t> parse_cpu_list(const std::string& text) {
+    std::vector<uint32_t> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range[0] == '\n') continue;
+        size_t dash = range.find('-');
+        try {
+            uint32_t first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+            uint32_t last = dash == std::string::npos ? first
+                                                      : static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+            for (uint32_t cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
+    }
+    return cpus;
+}
+
+bool read_sysfs_line(const std::string& path, std::string& value) {
+    std::ifstream file(path);
+    return static_cast<bool>(std::getline(file, value));
+}
+
+// "48K", "2048K", "32M" or a plain byte count
+uint32_t parse_cache_size(const std::string& text) {
+    try {
+        size_t end = 0;
+        unsigned long value = std::stoul(text, &end);
+        if (end < text.size()) {
+            if (text[end] == 'K') value *= 1024;
+            else if (text[end] == 'M') value *= 1024 * 1024;
+        }
+        return static_cast<uint32_t>(value);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+} // namespace
+
+std::string CPUFeatureDetector::detect_model_name() {
+    std::string name;
+    if (detect_architecture() == CPUArchitecture::X86_64 && has_cpuid()) {
+        uint32_t regs[4];
+        cpuid(0x80000000, 0, regs);
+        if (regs[0] >= 0x80000004) {
+            char brand[49] = {};
+            for (uint32_t leaf = 0; leaf < 3; ++leaf) {
+                cpuid(0x80000002 + leaf, 0, regs);
+                std::memcpy(brand + 16 * leaf, regs, 16);
+            }
+            name = brand;
+        }
+    }
+#ifdef __linux__
+    if (name.empty()) {
+        // "model name" on x86 and some ARM kernels; "CPU part" identifies the core elsewhere
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        std::string part;
+        while (std::getline(cpuinfo, line)) {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos || colon == 0) continue;
+            std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+            std::string value = line.substr(std::min(line.size(), colon + 2));
+            if (key == "model name" || key == "uarch" || key == "cpu") {
+                name = value;
+                break;
+            }
+            if (key == "CPU part" && part.empty()) part = "CPU part " + value;
+        }
+        if (name.empty()) name = part;
+    }
+#endif
+    // Trim the padding some brand strings carry
+    size_t first = name.find_first_not_of(' ');
+    size_t last = name.find_last_not_of(' ');
+    return first == std::string::npos ? std::string() : name.substr(first, last - first + 1);
+}
+
+void CPUFeatureDetector::detect_topology(CPUTopology& topology) {
+    if (detect_architecture() == CPUArchitecture::X86_64 && has_cpuid()) {
+        detect_x86_caches(topology);
+    }
+    // sysfs fills caches CPUID did not report, and describes every online
+    // package rather than just the one this thread runs on
+    read_sysfs_caches(topology);
+    read_sysfs_cores(topology);
+    if (topology.physical_cores == 0 && detect_architecture() == CPUArchitecture::X86_64 && has_cpuid()) {
+        detect_x86_cores(topology);
+    }
+
+    if (topology.logical_cores == 0) {
+        topology.logical_cores = std::thread::hardware_concurrency();
+    }
+    if (topology.threads_per_core == 0 && topology.physical_cores && topology.logical_cores) {
+        topology.threads_per_core = std::max(1u, topology.logical_cores / topology.physical_cores);
+    }
+    if (topology.physical_cores == 0 && topology.logical_cores) {
+        topology.physical_cores = topology.logical_cores / std::max(1u, topology.threads_per_core);
+    }
+}
+
+void CPUFeatureDetector::detect_x86_caches(CPUTopology& topology) {
+    uint32_t regs[4];
+    cpuid(0, 0, regs);
+    const uint32_t max_leaf = regs[0];
+    const bool amd = regs[1] == 0x68747541;  // "Auth" of AuthenticAMD
+
+    // Deterministic cache parameters: leaf 4 on Intel, 0x8000001D on AMD
+    uint32_t leaf = 0;
+    if (amd) {
+        cpuid(0x80000000, 0, regs);
+        if (regs[0] >= 0x8000001D) {
+            cpuid(0x80000001, 0, regs);
+            if (regs[2] & (1u << 22)) leaf = 0x8000001D;  // TopologyExtensions
+        }
+    } else if (max_leaf >= 4) {
+        leaf = 4;
+    }
+    if (leaf == 0) return;
+
+    for (uint32_t index = 0; index < 16; ++index) {
+        cpuid(leaf, index, regs);
+        uint32_t type = regs[0] & 0x1F;       // 1 data, 2 instruction, 3 unified
+        if (type == 0) break;
+        uint32_t level = (regs[0] >> 5) & 0x7;
+        uint32_t ways = ((regs[1] >> 22) & 0x3FF) + 1;
+        uint32_t partitions = ((regs[1] >> 12) & 0x3FF) + 1;
+        uint32_t line = (regs[1] & 0xFFF) + 1;
+        uint32_t sets = regs[2] + 1;
+        uint32_t size = ways * partitions * line * sets;
+
+        if (level == 1 && type == 1) topology.l1d_cache_size = size;
+        else if (level == 1 && type == 2) topology.l1i_cache_size = size;
+        else if (level == 2 && type != 2) topology.l2_cache_size = size;
+        else if (level == 3 && type != 2) topology.l3_cache_size = size;
+
+        if (level == 1 && type != 2) topology.cache_line_size = line;
+    }
+}
+
+void CPUFeatureDetector::detect_x86_cores(CPUTopology& topology) {
+    uint32_t regs[4];
+    cpuid(0, 0, regs);
+    if (regs[0] < 0xB) return;
+
+    // Extended topology: the SMT level counts threads per core, the core
+    // level counts threads per package
+    uint32_t smt = 0;
+    uint32_t package = 0;
+    for (uint32_t index = 0; index < 8; ++index) {
+        cpuid(0xB, index, regs);
+        uint32_t level_type = (regs[2] >> 8) & 0xFF;
+        if (level_type == 0) break;
+        uint32_t count = regs[1] & 0xFFFF;
+        if (level_type == 1) smt = count;
+        else if (level_type == 2) package = count;
+    }
+    if (smt == 0 || package == 0) return;
+
+    topology.threads_per_core = smt;
+    topology.logical_cores = package;
+    topology.physical_cores = package / smt;
+}
+
+void CPUFeatureDetector::read_sysfs_caches(CPUTopology& topology) {
+#ifdef __linux__
+    const std::string base = "/sys/devices/system/cpu/cpu0/cache/index";
+    for (uint32_t index = 0; index < 16; ++index) {
+        const std::string dir = base + std::to_string(index) + "/";
+        std::string level_text, type, size_text, line_text;
+        if (!read_sysfs_line(dir + "level", level_text) || !read_sysfs_line(dir + "type", type) ||
+            !read_sysfs_line(dir + "size", size_text)) {
+            break;
+        }
+        uint32_t level = static_cast<uint32_t>(std::atoi(level_text.c_str()));
+        uint32_t size = parse_cache_size(size_text);
+        bool data = type == "Data" || type == "Unified";
+
+        if (level == 1 && type == "Data" && !topology.l1d_cache_size) topology.l1d_cache_size = size;
+        else if (level == 1 && type == "Instruction" && !topology.l1i_cache_size) topology.l1i_cache_size = size;
+        else if (level == 2 && data && !topology.l2_cache_size) topology.l2_cache_size = size;
+        else if (level == 3 && data && !topology.l3_cache_size) topology.l3_cache_size = size;
+
+        if (level == 1 && data && !topology.cache_line_size && read_sysfs_line(dir + "coherency_line_size", line_text)) {
+            topology.cache_line_size = static_cast<uint32_t>(std::atoi(line_text.c_str()));
+        }
+    }
+#else
+    (void)topology;
+#endif
+}
+
+void CPUFeatureDetector::read_sysfs_cores(CPUTopology& topology) {
+#ifdef __linux__
+    const std::string base = "/sys/devices/system/cpu/";
+    std::string online;
+    if (!read_sysfs_line(base + "online", online)) return;
+    std::vector<uint32_t> cpus = parse_cpu_list(online);
+    if (cpus.empty()) return;
+
+    // A physical core is a distinct (package, core) pair
+    std::set<std::pair<int, int>> cores;
+    for (uint32_t cpu : cpus) {
+        const std::string dir = base + "cpu" + std::to_string(cpu) + "/topology/";
+        std::string package, core;
+        if (!read_sysfs_line(dir + "physical_package_id", package) || !read_sysfs_line(dir + "core_id", core)) {
+            return;
+        }
+        cores.emplace(std::atoi(package.c_str()), std::atoi(core.c_str()));
+    }
+
+    topology.logical_cores = static_cast<uint32_t>(cpus.size());
+    topology.physical_cores = static_cast<uint32_t>(cores.size());
+
+    std::string siblings;
+    if (read_sysfs_line(base + "cpu" + std::to_string(cpus[0]) + "/topology/thread_siblings_list", siblings)) {
+        topology.threads_per_core = static_cast<uint32_t>(parse_cpu_list(siblings).size());
+    }
+#else
+    (void)topology;
+#endif
+}
+
 bool CPUFeatureDetector::has_cpuid() {
 #if defined(__x86_64__) || defined(_M_X64)
     return true;
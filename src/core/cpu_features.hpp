@@ -1,6 +1,7 @@
 #ifndef CPU_FEATURES_HPP
 #define CPU_FEATURES_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -23,8 +24,29 @@ enum class SIMDSupport {
     VSX
 };
 
+// Cache sizes are per instance in bytes (one L2 per core, one L3 per package
+// on most parts); any field the platform does not report is 0
+struct CPUTopology {
+    uint32_t l1d_cache_size = 0;
+    uint32_t l1i_cache_size = 0;
+    uint32_t l2_cache_size = 0;
+    uint32_t l3_cache_size = 0;
+    uint32_t cache_line_size = 0;
+
+    uint32_t physical_cores = 0;
+    uint32_t logical_cores = 0;
+    uint32_t threads_per_core = 0;   // SMT siblings sharing one physical core
+
+    // Worker count for compute-bound pools: one per physical core
+    uint32_t default_thread_count() const;
+    // Items of item_bytes that fit in half of the cache at `level` (1-3),
+    // leaving the other half for everything else; at least 1
+    size_t items_per_cache(size_t item_bytes, uint32_t level) const;
+};
+
 struct CPUFeatures {
     CPUArchitecture architecture = CPUArchitecture::UNKNOWN;
+    std::string model_name;   // CPUID brand string or /proc/cpuinfo; empty when unknown
     SIMDSupport max_simd_support = SIMDSupport::NONE;
 
     bool has_avx2 = false;
@@ -42,12 +64,17 @@ struct CPUFeatures {
     bool has_vsx = false;
     bool has_altivec = false;
 
+    CPUTopology topology;
+
     std::string to_string() const;
 };
 
 class CPUFeatureDetector {
 public:
+    // Probes the CPU on every call
     static CPUFeatures detect();
+    // Probed once per process; every call returns the same immutable object
+    static const CPUFeatures& cached();
 
 private:
     static CPUFeatures detect_x86();
@@ -60,6 +87,13 @@ private:
 
     static CPUArchitecture detect_architecture();
 
+    static std::string detect_model_name();
+    static void detect_topology(CPUTopology& topology);
+    static void detect_x86_caches(CPUTopology& topology);
+    static void detect_x86_cores(CPUTopology& topology);
+    static void read_sysfs_caches(CPUTopology& topology);
+    static void read_sysfs_cores(CPUTopology& topology);
+
     static bool has_cpuid();
     static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t* regs);
     static uint64_t xgetbv(uint32_t xcr);
@@ -0,0 +1,189 @@
+#include "clwe/instrumentation.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CLWE_HAVE_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CLWE_HAVE_TSC
+#endif
+
+namespace clwe {
+
+namespace {
+
+// One slot per live thread. A slot outlives its thread and is handed to the
+// next new thread, so its totals keep counting and snapshots never lose them.
+struct alignas(64) CounterSlot {
+    std::atomic<uint64_t> calls[INSTRUMENTED_OP_COUNT];
+    std::atomic<uint64_t> cycles[INSTRUMENTED_OP_COUNT];
+    uint32_t depth[INSTRUMENTED_OP_COUNT];   // Owning thread only
+    bool in_use;                              // Guarded by the registry mutex
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<CounterSlot*> slots;
+};
+
+// Leaked on purpose: threads may exit after static destructors have run
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+// Trivially destructible, so timers in other thread_local destructors still work
+thread_local CounterSlot* thread_slot = nullptr;
+// Set once the exiting thread has handed its slot back. The slot may already
+// belong to a new thread, so timers that run later on this one record nothing.
+thread_local bool thread_retired = false;
+
+struct SlotReleaser {
+    ~SlotReleaser() {
+        thread_retired = true;
+        if (!thread_slot) return;
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        thread_slot->in_use = false;
+        thread_slot = nullptr;
+    }
+};
+
+thread_local SlotReleaser slot_releaser;
+
+// This thread's slot, or nullptr once the thread has retired
+CounterSlot* local_slot() {
+    if (thread_retired) return nullptr;
+    if (thread_slot) return thread_slot;
+
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (CounterSlot* slot : reg.slots) {
+            if (!slot->in_use) {
+                thread_slot = slot;
+                break;
+            }
+        }
+        if (!thread_slot) {
+            thread_slot = new CounterSlot();
+            reg.slots.push_back(thread_slot);
+        }
+        thread_slot->in_use = true;
+    }
+    // First use on this thread: touching the releaser registers its destructor
+    (void)&slot_releaser;
+    return thread_slot;
+}
+
+// Single writer per slot, so a relaxed load and store avoids a locked add
+inline void bump(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+const char* instrumented_op_name(InstrumentedOp op) {
+    switch (op) {
+        case InstrumentedOp::MatrixExpansion: return "matrix_expansion";
+        case InstrumentedOp::Sampling: return "sampling";
+        case InstrumentedOp::NTTForward: return "ntt_forward";
+        case InstrumentedOp::NTTInverse: return "ntt_inverse";
+        case InstrumentedOp::PointwiseMultiply: return "pointwise_multiply";
+        case InstrumentedOp::Serialization: return "serialization";
+        case InstrumentedOp::Deserialization: return "deserialization";
+        case InstrumentedOp::KeyGen: return "keygen";
+        case InstrumentedOp::Encapsulate: return "encapsulate";
+        case InstrumentedOp::Decapsulate: return "decapsulate";
+        case InstrumentedOp::Sign: return "sign";
+        case InstrumentedOp::Verify: return "verify";
+        default: return "unknown";
+    }
+}
+
+uint64_t read_cycle_counter() {
+#if defined(CLWE_HAVE_TSC)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+double cycle_counter_frequency() {
+    static const double frequency = [] {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = read_cycle_counter();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t c1 = read_cycle_counter();
+        auto t1 = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(t1 - t0).count();
+        return static_cast<double>(c1 - c0) / seconds;
+    }();
+    return frequency;
+}
+
+InstrumentationSnapshot instrumentation_snapshot() {
+    InstrumentationSnapshot snapshot;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const CounterSlot* slot : reg.slots) {
+        for (size_t i = 0; i < INSTRUMENTED_OP_COUNT; ++i) {
+            snapshot.counters[i].calls += slot->calls[i].load(std::memory_order_relaxed);
+            snapshot.counters[i].cycles += slot->cycles[i].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+void reset_instrumentation() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (CounterSlot* slot : reg.slots) {
+        for (size_t i = 0; i < INSTRUMENTED_OP_COUNT; ++i) {
+            slot->calls[i].store(0, std::memory_order_relaxed);
+            slot->cycles[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+ScopedCycleTimer::ScopedCycleTimer(InstrumentedOp op)
+    : op_(op), start_(0), outermost_(false) {
+    CounterSlot* slot = local_slot();
+    if (!slot) return;
+    outermost_ = slot->depth[static_cast<size_t>(op)]++ == 0;
+    if (outermost_) {
+#if defined(CLWE_HAVE_TSC)
+        _mm_lfence();  // Keep earlier work out of the timed region
+#endif
+        start_ = read_cycle_counter();
+    }
+}
+
+ScopedCycleTimer::~ScopedCycleTimer() {
+    if (thread_retired) return;
+    CounterSlot& slot = *thread_slot;
+    size_t i = static_cast<size_t>(op_);
+    --slot.depth[i];
+    if (!outermost_) return;
+
+#if defined(CLWE_HAVE_TSC)
+    unsigned int aux;
+    uint64_t end = __rdtscp(&aux);  // Waits for the timed work to retire
+#else
+    uint64_t end = read_cycle_counter();
+#endif
+    bump(slot.calls[i], 1);
+    bump(slot.cycles[i], end - start_);
+}
+
+} // namespace clwe
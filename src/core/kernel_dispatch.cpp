@@ -0,0 +1,118 @@
+#include "kernel_dispatch.hpp"
+#include "cpu_features.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace clwe {
+
+namespace {
+
+constexpr int NO_CAP = -1;
+
+// Set by set_kernel_tier_cap(); NO_CAP defers to the environment
+std::atomic<int> api_cap{NO_CAP};
+
+int environment_cap() {
+    static const int cap = [] {
+        const char* value = std::getenv("CLWE_FORCE_ISA");
+        if (!value || !*value) return NO_CAP;
+        KernelTier tier;
+        if (!parse_kernel_tier(value, tier)) {
+            // Engine constructors read the cap, so a typo must not make them throw
+            std::cerr << "clwe: ignoring CLWE_FORCE_ISA=" << value
+                      << " (expected scalar, avx2 or avx512)" << std::endl;
+            return NO_CAP;
+        }
+        return static_cast<int>(tier);
+    }();
+    return cap;
+}
+
+KernelTier min_tier(KernelTier a, KernelTier b) {
+    return static_cast<uint32_t>(a) < static_cast<uint32_t>(b) ? a : b;
+}
+
+} // namespace
+
+const char* kernel_tier_name(KernelTier tier) {
+    switch (tier) {
+        case KernelTier::Scalar: return "scalar";
+        case KernelTier::AVX2: return "avx2";
+        case KernelTier::AVX512: return "avx512";
+        default: return "unknown";
+    }
+}
+
+bool parse_kernel_tier(const std::string& name, KernelTier& tier) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (KernelTier candidate : {KernelTier::Scalar, KernelTier::AVX2, KernelTier::AVX512}) {
+        if (lower == kernel_tier_name(candidate)) {
+            tier = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+KernelTier compiled_kernel_tier() {
+#if defined(HAVE_AVX512)
+    return KernelTier::AVX512;
+#elif defined(HAVE_AVX2)
+    return KernelTier::AVX2;
+#else
+    return KernelTier::Scalar;
+#endif
+}
+
+KernelTier supported_kernel_tier() {
+    const CPUFeatures& features = CPUFeatureDetector::cached();
+    KernelTier cpu = features.has_avx512f ? KernelTier::AVX512
+                   : features.has_avx2 ? KernelTier::AVX2
+                   : KernelTier::Scalar;
+    return min_tier(compiled_kernel_tier(), cpu);
+}
+
+void set_kernel_tier_cap(KernelTier tier) {
+    api_cap.store(static_cast<int>(tier), std::memory_order_relaxed);
+}
+
+void clear_kernel_tier_cap() {
+    api_cap.store(NO_CAP, std::memory_order_relaxed);
+}
+
+KernelTier kernel_tier_cap() {
+    int cap = api_cap.load(std::memory_order_relaxed);
+    if (cap == NO_CAP) cap = environment_cap();
+    return cap == NO_CAP ? supported_kernel_tier() : static_cast<KernelTier>(cap);
+}
+
+KernelTier active_kernel_tier() {
+    return min_tier(supported_kernel_tier(), kernel_tier_cap());
+}
+
+std::string KernelSelection::to_string() const {
+    std::stringstream ss;
+    ss << "ntt: " << kernel_tier_name(ntt)
+       << ", pointwise: " << kernel_tier_name(pointwise)
+       << ", elementwise: " << kernel_tier_name(elementwise);
+    if (forced) ss << " (capped)";
+    return ss.str();
+}
+
+KernelSelection selected_kernels() {
+    KernelTier active = active_kernel_tier();
+    KernelSelection selection;
+    selection.ntt = active;
+    selection.pointwise = active;
+    selection.elementwise = min_tier(compiled_kernel_tier(), KernelTier::AVX2);
+    selection.forced = active != supported_kernel_tier();
+    return selection;
+}
+
+} // namespace clwe
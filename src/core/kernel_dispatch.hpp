@@ -0,0 +1,56 @@
+#ifndef KERNEL_DISPATCH_HPP
+#define KERNEL_DISPATCH_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace clwe {
+
+// Kernel tiers the runtime dispatcher can choose between. A tier is used only
+// when it is compiled in (HAVE_AVX2 / HAVE_AVX512) and the CPU supports it.
+//
+// The cap comes from set_kernel_tier_cap() or, until that is called, the
+// CLWE_FORCE_ISA environment variable (scalar, avx2 or avx512), read once;
+// any other value is reported on stderr and ignored.
+// Engines pick their tier at construction, so a new cap applies to engines
+// created afterwards. A cap above what the host supports has no effect.
+enum class KernelTier : uint32_t {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+const char* kernel_tier_name(KernelTier tier);
+// Accepts the names produced by kernel_tier_name(), case-insensitively
+bool parse_kernel_tier(const std::string& name, KernelTier& tier);
+
+// Highest tier compiled into this build
+KernelTier compiled_kernel_tier();
+// Highest tier compiled in and supported by this CPU
+KernelTier supported_kernel_tier();
+
+void set_kernel_tier_cap(KernelTier tier);
+// Drops an API cap and returns to CLWE_FORCE_ISA (or no cap)
+void clear_kernel_tier_cap();
+// The effective cap; supported_kernel_tier() when nothing caps dispatch
+KernelTier kernel_tier_cap();
+
+// Tier new engines and runtime-dispatched kernels use
+KernelTier active_kernel_tier();
+
+// Tier each kernel family runs at under the current cap. Sampling is scalar
+// (SHAKE-bound) at every tier.
+struct KernelSelection {
+    KernelTier ntt;            // AVXNTTEngine transforms
+    KernelTier pointwise;      // AVXNTTEngine pointwise products
+    KernelTier elementwise;    // Polynomial add/sub, packing, rounding (fixed at compile time)
+    bool forced;               // A cap below supported_kernel_tier() is in effect
+
+    std::string to_string() const;
+};
+
+KernelSelection selected_kernels();
+
+} // namespace clwe
+
+#endif // KERNEL_DISPATCH_HPP
@@ -0,0 +1,56 @@
+#include "memory_resource.hpp"
+#include "pool_allocator.hpp"
+#include <new>
+
+namespace clwe {
+
+namespace {
+
+class PoolMemoryResource : public std::pmr::memory_resource {
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (alignment > PoolAllocator::ALIGNMENT) {
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+        return PoolAllocator::allocate(bytes);
+    }
+
+    void do_deallocate(void* ptr, size_t, size_t alignment) override {
+        if (alignment > PoolAllocator::ALIGNMENT) {
+            ::operator delete(ptr, std::align_val_t(alignment));
+        } else {
+            PoolAllocator::deallocate(ptr);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+thread_local std::pmr::memory_resource* scoped_resource = nullptr;
+
+} // namespace
+
+std::pmr::memory_resource* pool_memory_resource() {
+    // Leaked on purpose: polynomials may be freed during static destruction
+    static PoolMemoryResource* resource = new PoolMemoryResource;
+    return resource;
+}
+
+std::pmr::memory_resource* current_memory_resource() {
+    return scoped_resource ? scoped_resource : pool_memory_resource();
+}
+
+ScopedMemoryResource::ScopedMemoryResource(std::pmr::memory_resource* resource)
+    : previous_(scoped_resource) {
+    if (resource) {
+        scoped_resource = resource;
+    }
+}
+
+ScopedMemoryResource::~ScopedMemoryResource() {
+    scoped_resource = previous_;
+}
+
+} // namespace clwe
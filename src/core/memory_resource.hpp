@@ -0,0 +1,32 @@
+#ifndef MEMORY_RESOURCE_HPP
+#define MEMORY_RESOURCE_HPP
+
+#include <memory_resource>
+
+namespace clwe {
+
+// std::pmr view of PoolAllocator (pool_allocator.hpp); never destroyed
+std::pmr::memory_resource* pool_memory_resource();
+
+// Resource for allocations made without an explicit one: the innermost
+// ScopedMemoryResource on the calling thread, otherwise the pool
+std::pmr::memory_resource* current_memory_resource();
+
+// Redirects this thread's polynomial and scratch allocations to `resource`
+// until destroyed; nullptr leaves the current resource in place. Entry
+// points taking a memory_resource* install one of these.
+class ScopedMemoryResource {
+private:
+    std::pmr::memory_resource* previous_;
+
+public:
+    explicit ScopedMemoryResource(std::pmr::memory_resource* resource);
+    ~ScopedMemoryResource();
+
+    ScopedMemoryResource(const ScopedMemoryResource&) = delete;
+    ScopedMemoryResource& operator=(const ScopedMemoryResource&) = delete;
+};
+
+} // namespace clwe
+
+#endif // MEMORY_RESOURCE_HPP
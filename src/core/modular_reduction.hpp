@@ -0,0 +1,490 @@
+#ifndef MODULAR_REDUCTION_HPP
+#define MODULAR_REDUCTION_HPP
+
+#include "utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Modular reduction policies shared by the NTT engines and polynomial kernels.
+//
+// Each policy is a literal type built from the modulus, so fixed moduli fold
+// at compile time (`constexpr BarrettReducer kyber(3329);`). Operations are
+// templated over the lane type: uint32_t for scalar code, __m256i (AVX2 or
+// the portable fallback) and, with HAVE_AVX512, __m512i. Every result is
+// fully reduced to [0, q).
+//
+//   BarrettReducer     x mod q for any 32-bit x; a * b mod q for a, b < q < 2^30
+//   MontgomeryReducer  a * b * 2^-32 mod q for odd q < 2^31 and a * b < q * 2^32
+//   ShoupMultiplier    a * w mod q for a constant w, any 32-bit a, q < 2^31
+//   SpecialFormReducer<Q>  Montgomery and Barrett with the multiplications by Q
+//                      replaced by shifts and adds, for Q with a sparse signed-binary form
+
+namespace clwe {
+
+enum class ReductionStrategy {
+    Montgomery,
+    Barrett,
+    Shoup,      // Constant operands only; variable products fall back to Barrett
+    SpecialForm // Shift/add products by q; only for moduli with a special-form kernel
+};
+
+inline const char* reduction_strategy_name(ReductionStrategy strategy) {
+    switch (strategy) {
+        case ReductionStrategy::Montgomery: return "montgomery";
+        case ReductionStrategy::Barrett: return "barrett";
+        case ReductionStrategy::Shoup: return "shoup";
+        case ReductionStrategy::SpecialForm: return "special-form";
+    }
+    return "unknown";
+}
+
+// Lane primitives. mont_mul is per lane type because the widening products
+// differ; everything else in the policies is written against these. They are
+// plain structs picked by LaneOps<Lane> below rather than specializations on
+// the vector types, whose alignment attributes GCC would report as ignored
+// template arguments (-Wignored-attributes).
+struct ScalarLane {
+    static constexpr uint32_t width = 1;
+    static uint32_t load(const uint32_t* p) { return *p; }
+    static void store(uint32_t* p, uint32_t v) { *p = v; }
+    static uint32_t set1(uint32_t v) { return v; }
+    static uint32_t add(uint32_t a, uint32_t b) { return a + b; }
+    static uint32_t sub(uint32_t a, uint32_t b) { return a - b; }
+    static uint32_t mullo(uint32_t a, uint32_t b) { return a * b; }
+    static uint32_t mulhi(uint32_t a, uint32_t b) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> 32);
+    }
+    static uint32_t shl(uint32_t a, uint32_t n) { return a << n; }
+    static uint32_t shr(uint32_t a, uint32_t n) { return a >> n; }
+    // Maps [0, 2q) to [0, q)
+    static uint32_t csub(uint32_t a, uint32_t q) { return a >= q ? a - q : a; }
+
+    // mul_q(m) returns m * q for the 32-bit m in the low half of a 64-bit lane
+    template<typename MulQ>
+    static uint32_t mont_mul_with(uint32_t a, uint32_t b, uint32_t q, uint32_t q_neg_inv, MulQ mul_q) {
+        uint64_t p = static_cast<uint64_t>(a) * b;
+        uint64_t m = static_cast<uint32_t>(p) * q_neg_inv;
+        return csub(static_cast<uint32_t>((p + mul_q(m)) >> 32), q);
+    }
+
+    static uint32_t mont_mul(uint32_t a, uint32_t b, uint32_t q, uint32_t q_neg_inv) {
+        return mont_mul_with(a, b, q, q_neg_inv, [q](uint64_t m) { return m * q; });
+    }
+};
+
+// __m256i lanes: AVX2, or the portable fallback
+struct Avx2Lane {
+    static constexpr uint32_t width = 8;
+#ifdef HAVE_AVX2
+    static __m256i load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(uint32_t* p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static __m256i set1(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+    static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+    static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+    static __m256i mullo(__m256i a, __m256i b) { return _mm256_mullo_epi32(a, b); }
+    static __m256i mulhi(__m256i a, __m256i b) {
+        __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        return _mm256_blend_epi32(even, odd, 0xAA);
+    }
+    static __m256i shl(__m256i a, uint32_t n) { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(static_cast<int>(n))); }
+    static __m256i shr(__m256i a, uint32_t n) { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(static_cast<int>(n))); }
+    static __m256i csub(__m256i a, __m256i q) { return _mm256_min_epu32(a, _mm256_sub_epi32(a, q)); }
+
+    // Even lanes in the low halves of 64-bit products, odd lanes shifted down.
+    // mul_q sees m in the low half of each 64-bit lane; the high half is garbage.
+    template<typename MulQ>
+    static __m256i mont_mul_with(__m256i a, __m256i b, __m256i q, __m256i q_neg_inv, MulQ mul_q) {
+        __m256i prod_even = _mm256_mul_epu32(a, b);
+        __m256i prod_odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        __m256i t_even = _mm256_mul_epu32(prod_even, q_neg_inv);
+        __m256i t_odd = _mm256_mul_epu32(prod_odd, q_neg_inv);
+        __m256i sum_even = _mm256_add_epi64(prod_even, mul_q(t_even));
+        __m256i sum_odd = _mm256_add_epi64(prod_odd, mul_q(t_odd));
+        return csub(_mm256_blend_epi32(_mm256_srli_epi64(sum_even, 32), sum_odd, 0xAA), q);
+    }
+
+    static __m256i mont_mul(__m256i a, __m256i b, __m256i q, __m256i q_neg_inv) {
+        return mont_mul_with(a, b, q, q_neg_inv, [q](__m256i m) { return _mm256_mul_epu32(m, q); });
+    }
+#else
+    static __m256i load(const uint32_t* p) {
+        __m256i r;
+        std::memcpy(r.m, p, sizeof(r.m));
+        return r;
+    }
+    static void store(uint32_t* p, __m256i v) { std::memcpy(p, v.m, sizeof(v.m)); }
+    static __m256i set1(uint32_t v) {
+        __m256i r;
+        for (int j = 0; j < 8; ++j) r.m[j] = v;
+        return r;
+    }
+    template<typename F>
+    static __m256i map(__m256i a, __m256i b, F f) {
+        for (int j = 0; j < 8; ++j) a.m[j] = f(a.m[j], b.m[j]);
+        return a;
+    }
+    static __m256i add(__m256i a, __m256i b) { return map(a, b, ScalarLane::add); }
+    static __m256i sub(__m256i a, __m256i b) { return map(a, b, ScalarLane::sub); }
+    static __m256i mullo(__m256i a, __m256i b) { return map(a, b, ScalarLane::mullo); }
+    static __m256i mulhi(__m256i a, __m256i b) { return map(a, b, ScalarLane::mulhi); }
+    static __m256i csub(__m256i a, __m256i q) { return map(a, q, ScalarLane::csub); }
+    static __m256i shl(__m256i a, uint32_t n) {
+        for (int j = 0; j < 8; ++j) a.m[j] <<= n;
+        return a;
+    }
+    static __m256i shr(__m256i a, uint32_t n) {
+        for (int j = 0; j < 8; ++j) a.m[j] >>= n;
+        return a;
+    }
+    template<typename MulQ>
+    static __m256i mont_mul_with(__m256i a, __m256i b, __m256i q, __m256i q_neg_inv, MulQ mul_q) {
+        for (int j = 0; j < 8; ++j) {
+            a.m[j] = ScalarLane::mont_mul_with(a.m[j], b.m[j], q.m[j], q_neg_inv.m[j], mul_q);
+        }
+        return a;
+    }
+
+    static __m256i mont_mul(__m256i a, __m256i b, __m256i q, __m256i q_neg_inv) {
+        for (int j = 0; j < 8; ++j) a.m[j] = ScalarLane::mont_mul(a.m[j], b.m[j], q.m[j], q_neg_inv.m[j]);
+        return a;
+    }
+#endif
+};
+
+#ifdef HAVE_AVX512
+// GCC 12's AVX-512 intrinsics (_mm512_mul_epu32, _mm512_srli_epi64, ...) pass
+// _mm512_undefined_epi32() as the unused merge operand, which -Wall reports as
+// "'__Y' may be used uninitialized" once the lane code is inlined (GCC PR 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+struct Avx512Lane {
+    static constexpr uint32_t width = 16;
+    static __m512i load(const uint32_t* p) { return _mm512_loadu_si512(p); }
+    static void store(uint32_t* p, __m512i v) { _mm512_storeu_si512(p, v); }
+    static __m512i set1(uint32_t v) { return _mm512_set1_epi32(static_cast<int>(v)); }
+    static __m512i add(__m512i a, __m512i b) { return _mm512_add_epi32(a, b); }
+    static __m512i sub(__m512i a, __m512i b) { return _mm512_sub_epi32(a, b); }
+    static __m512i mullo(__m512i a, __m512i b) { return _mm512_mullo_epi32(a, b); }
+    static __m512i mulhi(__m512i a, __m512i b) {
+        __m512i even = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+        __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+        return _mm512_mask_blend_epi32(0xAAAA, even, odd);
+    }
+    static __m512i shl(__m512i a, uint32_t n) { return _mm512_sll_epi32(a, _mm_cvtsi32_si128(static_cast<int>(n))); }
+    static __m512i shr(__m512i a, uint32_t n) { return _mm512_srl_epi32(a, _mm_cvtsi32_si128(static_cast<int>(n))); }
+    static __m512i csub(__m512i a, __m512i q) { return _mm512_min_epu32(a, _mm512_sub_epi32(a, q)); }
+
+    template<typename MulQ>
+    static __m512i mont_mul_with(__m512i a, __m512i b, __m512i q, __m512i q_neg_inv, MulQ mul_q) {
+        __m512i prod_even = _mm512_mul_epu32(a, b);
+        __m512i prod_odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+        __m512i t_even = _mm512_mul_epu32(prod_even, q_neg_inv);
+        __m512i t_odd = _mm512_mul_epu32(prod_odd, q_neg_inv);
+        __m512i sum_even = _mm512_add_epi64(prod_even, mul_q(t_even));
+        __m512i sum_odd = _mm512_add_epi64(prod_odd, mul_q(t_odd));
+        return csub(_mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(sum_even, 32), sum_odd), q);
+    }
+
+    static __m512i mont_mul(__m512i a, __m512i b, __m512i q, __m512i q_neg_inv) {
+        return mont_mul_with(a, b, q, q_neg_inv, [q](__m512i m) { return _mm512_mul_epu32(m, q); });
+    }
+};
+#endif
+
+// Lane primitives for a lane type: LaneOps<uint32_t>, LaneOps<__m256i>, ...
+ScalarLane lane_ops(uint32_t);
+Avx2Lane lane_ops(__m256i);
+#ifdef HAVE_AVX512
+Avx512Lane lane_ops(__m512i);
+#endif
+
+template<typename Lane>
+using LaneOps = decltype(lane_ops(std::declval<Lane>()));
+
+namespace reduction_detail {
+
+constexpr uint32_t constexpr_bit_length(uint32_t x) {
+    return x == 0 ? 0 : 1 + constexpr_bit_length(x >> 1);
+}
+
+// Non-adjacent form q = sum of +-2^shift[i], lowest term first
+struct SparseForm {
+    uint32_t count;
+    uint32_t shift[33];
+    bool negative[33];
+};
+
+constexpr SparseForm sparse_form(uint32_t q) {
+    SparseForm form{};
+    uint64_t x = q;
+    for (uint32_t bit = 0; x != 0; ++bit, x >>= 1) {
+        if (x & 1) {
+            bool negative = (x & 3) == 3;
+            form.shift[form.count] = bit;
+            form.negative[form.count] = negative;
+            ++form.count;
+            x = negative ? x + 1 : x - 1;
+        }
+    }
+    return form;
+}
+
+// Shift/add building blocks over 32-bit lanes and over 64-bit lanes (the
+// layout Montgomery products use); scalar code uses uint32_t / uint64_t.
+template<int N> inline uint32_t shl32(uint32_t a) { return a << N; }
+inline uint32_t add32(uint32_t a, uint32_t b) { return a + b; }
+inline uint32_t sub32(uint32_t a, uint32_t b) { return a - b; }
+template<int N> inline uint64_t shl64(uint64_t a) { return a << N; }
+inline uint64_t add64(uint64_t a, uint64_t b) { return a + b; }
+inline uint64_t sub64(uint64_t a, uint64_t b) { return a - b; }
+inline uint64_t low32(uint64_t a) { return a & 0xFFFFFFFFu; }
+
+#ifdef HAVE_AVX2
+template<int N> inline __m256i shl32(__m256i a) { return _mm256_slli_epi32(a, N); }
+inline __m256i add32(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+inline __m256i sub32(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+template<int N> inline __m256i shl64(__m256i a) { return _mm256_slli_epi64(a, N); }
+inline __m256i add64(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }
+inline __m256i sub64(__m256i a, __m256i b) { return _mm256_sub_epi64(a, b); }
+inline __m256i low32(__m256i a) { return _mm256_blend_epi32(a, _mm256_setzero_si256(), 0xAA); }
+#else
+template<int N> inline __m256i shl32(__m256i a) {
+    for (int j = 0; j < 8; ++j) a.m[j] <<= N;
+    return a;
+}
+inline __m256i add32(__m256i a, __m256i b) { return Avx2Lane::add(a, b); }
+inline __m256i sub32(__m256i a, __m256i b) { return Avx2Lane::sub(a, b); }
+#endif
+
+#ifdef HAVE_AVX512
+template<int N> inline __m512i shl32(__m512i a) { return _mm512_slli_epi32(a, N); }
+inline __m512i add32(__m512i a, __m512i b) { return _mm512_add_epi32(a, b); }
+inline __m512i sub32(__m512i a, __m512i b) { return _mm512_sub_epi32(a, b); }
+template<int N> inline __m512i shl64(__m512i a) { return _mm512_slli_epi64(a, N); }
+inline __m512i add64(__m512i a, __m512i b) { return _mm512_add_epi64(a, b); }
+inline __m512i sub64(__m512i a, __m512i b) { return _mm512_sub_epi64(a, b); }
+inline __m512i low32(__m512i a) { return _mm512_mask_blend_epi32(0xAAAA, a, _mm512_setzero_si512()); }
+#endif
+#if defined(HAVE_AVX512) && defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace reduction_detail
+
+class BarrettReducer {
+private:
+    uint32_t q_;
+    uint32_t k_;        // bit length of q
+    uint32_t m_;        // floor(2^32 / q), for 32-bit inputs
+    uint32_t mu_;       // floor(2^(k + 31) / q), for products below q^2
+
+public:
+    constexpr explicit BarrettReducer(uint32_t q)
+        : q_(q), k_(reduction_detail::constexpr_bit_length(q)),
+          m_(static_cast<uint32_t>((static_cast<uint64_t>(1) << 32) / q)),
+          mu_(static_cast<uint32_t>((static_cast<uint64_t>(1) << (reduction_detail::constexpr_bit_length(q) + 31)) / q)) {
+        if (q < 3 || q >= (1u << 30)) {
+            throw std::invalid_argument("Barrett modulus must be in [3, 2^30)");
+        }
+    }
+
+    constexpr uint32_t modulus() const { return q_; }
+    constexpr uint32_t constant() const { return m_; }
+
+    template<typename Lane>
+    Lane reduce(Lane a) const {
+        using L = LaneOps<Lane>;
+        const Lane q = L::set1(q_);
+        Lane t = L::mulhi(a, L::set1(m_));
+        return L::csub(L::sub(a, L::mullo(t, q)), q);
+    }
+
+    // The quotient estimate from (a * b) >> (k - 1) is short by at most 2
+    template<typename Lane>
+    Lane mul(Lane a, Lane b) const {
+        using L = LaneOps<Lane>;
+        const Lane q = L::set1(q_);
+        Lane lo = L::mullo(a, b);
+        Lane x = L::add(L::shl(L::mulhi(a, b), 33 - k_), L::shr(lo, k_ - 1));
+        Lane t = L::mulhi(x, L::set1(mu_));
+        Lane r = L::sub(lo, L::mullo(t, q));
+        return L::csub(L::csub(r, L::set1(2 * q_)), q);
+    }
+};
+
+class MontgomeryReducer {
+private:
+    uint32_t q_;
+    uint32_t q_neg_inv_;    // -q^(-1) mod 2^32
+    uint32_t r_;            // 2^32 mod q
+    uint32_t r2_;           // 2^64 mod q
+
+    static constexpr uint32_t neg_inverse(uint32_t q) {
+        // Newton iteration doubles the correct low bits each step
+        uint32_t inv = q;
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2 - q * inv;
+        }
+        return 0u - inv;
+    }
+
+public:
+    constexpr explicit MontgomeryReducer(uint32_t q)
+        : q_(q), q_neg_inv_(neg_inverse(q)),
+          r_(static_cast<uint32_t>((static_cast<uint64_t>(1) << 32) % q)),
+          r2_(static_cast<uint32_t>(((static_cast<uint64_t>(1) << 32) % q) * ((static_cast<uint64_t>(1) << 32) % q) % q)) {
+        if ((q & 1) == 0 || q >= (1u << 31)) {
+            throw std::invalid_argument("Montgomery modulus must be odd and below 2^31");
+        }
+    }
+
+    constexpr uint32_t modulus() const { return q_; }
+    constexpr uint32_t neg_inverse() const { return q_neg_inv_; }
+    constexpr uint32_t r() const { return r_; }
+    constexpr uint32_t r2() const { return r2_; }
+
+    // val * 2^-32 mod q for val < q * 2^32
+    constexpr uint32_t reduce(uint64_t val) const {
+        uint32_t m = static_cast<uint32_t>(val) * q_neg_inv_;
+        uint64_t r = (val + static_cast<uint64_t>(m) * q_) >> 32;
+        return static_cast<uint32_t>(r >= q_ ? r - q_ : r);
+    }
+
+    constexpr uint32_t to_montgomery(uint32_t a) const {
+        return static_cast<uint32_t>((static_cast<uint64_t>(a % q_) << 32) % q_);
+    }
+    constexpr uint32_t from_montgomery(uint32_t a) const { return reduce(a); }
+
+    template<typename Lane>
+    Lane mul(Lane a, Lane b) const {
+        using L = LaneOps<Lane>;
+        return L::mont_mul(a, b, L::set1(q_), L::set1(q_neg_inv_));
+    }
+};
+
+class ShoupMultiplier {
+private:
+    uint32_t q_;
+    uint32_t w_;
+    uint32_t w_shoup_;     // floor(w * 2^32 / q)
+
+public:
+    static constexpr uint32_t precompute(uint32_t w, uint32_t q) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(w) << 32) / q);
+    }
+
+    constexpr ShoupMultiplier(uint32_t w, uint32_t q)
+        : q_(q), w_(w % q), w_shoup_(precompute(w % q, q)) {
+        if (q < 3 || q >= (1u << 31)) {
+            throw std::invalid_argument("Shoup modulus must be in [3, 2^31)");
+        }
+    }
+
+    constexpr uint32_t modulus() const { return q_; }
+    constexpr uint32_t multiplier() const { return w_; }
+    constexpr uint32_t shoup() const { return w_shoup_; }
+
+    // a * w - mulhi(a, w') * q lies in [0, 2q) for any 32-bit a
+    template<typename Lane>
+    static Lane mul(Lane a, Lane w, Lane w_shoup, Lane q) {
+        using L = LaneOps<Lane>;
+        Lane t = L::mulhi(a, w_shoup);
+        return L::csub(L::sub(L::mullo(a, w), L::mullo(t, q)), q);
+    }
+
+    template<typename Lane>
+    Lane mul(Lane a) const {
+        using L = LaneOps<Lane>;
+        return mul(a, L::set1(w_), L::set1(w_shoup_), L::set1(q_));
+    }
+};
+
+// Terms allowed in the signed-binary form of a special-form modulus
+constexpr uint32_t SPECIAL_FORM_MAX_TERMS = 4;
+
+// Reducers for a modulus fixed at compile time, e.g.
+// 3329 = 2^12 - 2^10 + 2^8 + 1 or 8380417 = 2^23 - 2^13 + 1. Products by Q
+// become shifts and adds; mul() is Montgomery (a * b * 2^-32 mod Q, same
+// domain as MontgomeryReducer) and reduce() is Barrett.
+template<uint32_t Q>
+class SpecialFormReducer {
+private:
+    static constexpr reduction_detail::SparseForm form_ = reduction_detail::sparse_form(Q);
+    static constexpr MontgomeryReducer montgomery_{Q};
+    static constexpr uint32_t m_ = static_cast<uint32_t>((static_cast<uint64_t>(1) << 32) / Q);
+
+    static_assert(form_.count <= SPECIAL_FORM_MAX_TERMS, "Modulus has no sparse signed-binary form");
+    static_assert((Q & 1) && Q < (1u << 30), "Special-form modulus must be odd and below 2^30");
+
+    // t * Q as a signed sum of shifted copies of t
+    template<std::size_t I = 0, typename Lane>
+    static Lane times_q32(Lane t, Lane acc = Lane{}) {
+        using namespace reduction_detail;
+        if constexpr (I == form_.count) {
+            return acc;
+        } else {
+            Lane term = shl32<form_.shift[I]>(t);
+            return times_q32<I + 1>(t, form_.negative[I] ? sub32(acc, term) : add32(acc, term));
+        }
+    }
+
+    template<std::size_t I = 0, typename Wide>
+    static Wide times_q64(Wide t, Wide acc = Wide{}) {
+        using namespace reduction_detail;
+        if constexpr (I == form_.count) {
+            return acc;
+        } else {
+            Wide term = shl64<form_.shift[I]>(t);
+            return times_q64<I + 1>(t, form_.negative[I] ? sub64(acc, term) : add64(acc, term));
+        }
+    }
+
+public:
+    static constexpr uint32_t modulus() { return Q; }
+    static constexpr const MontgomeryReducer& montgomery() { return montgomery_; }
+
+    template<typename Lane>
+    static Lane mul(Lane a, Lane b) {
+        using L = LaneOps<Lane>;
+        return L::mont_mul_with(a, b, L::set1(Q), L::set1(montgomery_.neg_inverse()),
+                                [](auto m) { return times_q64(reduction_detail::low32(m)); });
+    }
+
+    template<typename Lane>
+    static Lane reduce(Lane a) {
+        using L = LaneOps<Lane>;
+        Lane t = L::mulhi(a, L::set1(m_));
+        return L::csub(L::sub(a, times_q32(t)), L::set1(Q));
+    }
+};
+
+// Calls f(std::integral_constant<uint32_t, q>) if q has a special-form kernel.
+// Kernels need Q at compile time, so only the moduli listed here qualify;
+// SpecialFormReducer rejects any entry without a sparse form.
+template<typename F>
+bool dispatch_special_form(uint32_t q, F&& f) {
+    switch (q) {
+        case 3329: f(std::integral_constant<uint32_t, 3329>()); return true;
+        case 7681: f(std::integral_constant<uint32_t, 7681>()); return true;
+        case 12289: f(std::integral_constant<uint32_t, 12289>()); return true;
+        case 8380417: f(std::integral_constant<uint32_t, 8380417>()); return true;
+        default: return false;
+    }
+}
+
+inline bool has_special_form_kernel(uint32_t q) {
+    return dispatch_special_form(q, [](auto) {});
+}
+
+} // namespace clwe
+
+#endif // MODULAR_REDUCTION_HPP
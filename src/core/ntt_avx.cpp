@@ -1,8 +1,11 @@
 #include "ntt_avx.hpp"
+#include "clwe/instrumentation.hpp"
 #include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <unordered_map>
+#include <stdexcept>
+#include <new>
 
 #ifdef HAVE_AVX2
 #include <immintrin.h>
@@ -12,56 +15,114 @@
 #include <immintrin.h>
 #endif
 
-uint32_t mod_pow(uint32_t base, uint32_t exp, uint32_t mod) {
-    uint32_t result = 1;
-    base %= mod;
-    while (exp > 0) {
-        if (exp & 1) {
-            result = (static_cast<uint64_t>(result) * base) % mod;
-        }
-        base = (static_cast<uint64_t>(base) * base) % mod;
-        exp >>= 1;
-    }
-    return result;
-}
-
 namespace clwe {
 
-AVXNTTEngine::AVXNTTEngine(uint32_t q, uint32_t n)
-    : q_(q), n_(n), log_n_(bit_length(n) - 1),
-      zetas_(nullptr), zetas_inv_(nullptr), bitrev_(nullptr),
-      zetas_avx512_(nullptr), zetas_inv_avx512_(nullptr),
-      montgomery_r_(0), montgomery_r_inv_(0) {
+namespace {
 
-    if (!is_power_of_two(n)) {
-        throw std::invalid_argument("NTT degree must be a power of 2");
+// Smallest generator of Z_q^* for prime q
+uint32_t find_generator(uint32_t q) {
+    std::vector<uint32_t> factors;
+    uint32_t m = q - 1;
+    for (uint32_t p = 2; static_cast<uint64_t>(p) * p <= m; ++p) {
+        if (m % p == 0) {
+            factors.push_back(p);
+            while (m % p == 0) m /= p;
+        }
     }
+    if (m > 1) factors.push_back(m);
+
+    for (uint32_t g = 2; g < q; ++g) {
+        bool generator = true;
+        for (uint32_t p : factors) {
+            if (mod_pow(g, (q - 1) / p, q) == 1) {
+                generator = false;
+                break;
+            }
+        }
+        if (generator) return g;
+    }
+    throw std::invalid_argument("NTT modulus must be prime");
+}
 
-    montgomery_r_ = (1ULL << 32) % q_;
-    montgomery_r_inv_ = mod_inverse(montgomery_r_, q_);
-
-#ifdef HAVE_AVX512
-    size_t avx512_count = n / 16;
-    zetas_avx512_ = static_cast<__m512i*>(AVXAllocator::allocate(avx512_count * sizeof(__m512i)));
-    zetas_inv_avx512_ = static_cast<__m512i*>(AVXAllocator::allocate(avx512_count * sizeof(__m512i)));
+// Swaps the two lanes of every 64-bit pair
+__m256i swap_pairs(__m256i a) {
+#ifdef HAVE_AVX2
+    return _mm256_shuffle_epi32(a, 0xB1);
+#else
+    for (int j = 0; j < 8; j += 2) std::swap(a.m[j], a.m[j + 1]);
+    return a;
 #endif
+}
 
+// Even lanes from a, odd lanes from b
+__m256i interleave_pairs(__m256i a, __m256i b) {
 #ifdef HAVE_AVX2
-    size_t avx_count = n / 8;
-    zetas_ = static_cast<__m256i*>(AVXAllocator::allocate(avx_count * sizeof(__m256i)));
-    zetas_inv_ = static_cast<__m256i*>(AVXAllocator::allocate(avx_count * sizeof(__m256i)));
+    return _mm256_blend_epi32(a, b, 0xAA);
 #else
-    zetas_ = static_cast<__m256i*>(AVXAllocator::allocate(n * sizeof(uint32_t)));
-    zetas_inv_ = static_cast<__m256i*>(AVXAllocator::allocate(n * sizeof(uint32_t)));
+    for (int j = 1; j < 8; j += 2) a.m[j] = b.m[j];
+    return a;
 #endif
+}
 
-    bitrev_ = static_cast<uint32_t*>(AVXAllocator::allocate(n * sizeof(uint32_t)));
-
-    if ((!zetas_ || !zetas_inv_ || !bitrev_)
 #ifdef HAVE_AVX512
-        || (!zetas_avx512_ || !zetas_inv_avx512_)
+// GCC 12 false positive on _mm512_undefined_epi32(); see Avx512Lane
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
 #endif
-        ) {
+__m512i swap_pairs(__m512i a) {
+    return _mm512_shuffle_epi32(a, _MM_PERM_CDAB);
+}
+
+__m512i interleave_pairs(__m512i a, __m512i b) {
+    return _mm512_mask_blend_epi32(0xAAAA, a, b);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+uint32_t bit_reverse_bits(uint32_t x, uint32_t bits) {
+    uint32_t r = 0;
+    for (uint32_t i = 0; i < bits; ++i) {
+        r |= ((x >> i) & 1) << (bits - 1 - i);
+    }
+    return r;
+}
+
+} // namespace
+
+AVXNTTEngine::AVXNTTEngine(uint32_t q, uint32_t n, ReductionStrategy strategy, KernelTier tier)
+    : q_(q), n_(n), log_n_(0), zetas_(nullptr), bitrev_(nullptr),
+      layers_(0), base_degree_(n), strategy_(strategy),
+      tier_(std::min(tier, supported_kernel_tier())), montgomery_(q),
+      barrett_(q < (1u << 30) ? q : 3), inv_scale_(0), inv_scale_shoup_(0) {
+
+    if (!is_power_of_two(n) || n < 8) {
+        throw std::invalid_argument("NTT degree must be a power of 2 and at least 8");
+    }
+    if ((q & 1) == 0 || q >= (1u << 31)) {
+        throw std::invalid_argument("NTT modulus must be odd and below 2^31");
+    }
+    if (strategy_ != ReductionStrategy::Montgomery && q >= (1u << 30)) {
+        throw std::invalid_argument("Barrett and Shoup reduction require a modulus below 2^30");
+    }
+    if (strategy_ == ReductionStrategy::SpecialForm && !has_special_form_kernel(q)) {
+        throw std::invalid_argument("No special-form reduction kernel for this modulus");
+    }
+    log_n_ = bit_length(n) - 1;
+
+    // The largest power-of-two root order available decides how far X^n + 1 splits
+    uint32_t two_adic = __builtin_ctz(q_ - 1);
+    uint32_t root_order_log = std::min(two_adic, log_n_ + 1);
+    layers_ = root_order_log > 0 ? root_order_log - 1 : 0;
+    base_degree_ = n_ >> layers_;
+
+    zetas_ = static_cast<__m256i*>(AVXAllocator::allocate((n / 8) * sizeof(__m256i)));
+    bitrev_ = static_cast<uint32_t*>(AVXAllocator::allocate(n * sizeof(uint32_t)));
+
+    if (!zetas_ || !bitrev_) {
         throw std::bad_alloc();
     }
 
@@ -71,256 +132,325 @@ AVXNTTEngine::AVXNTTEngine(uint32_t q, uint32_t n)
 
 AVXNTTEngine::~AVXNTTEngine() {
     if (zetas_) AVXAllocator::deallocate(zetas_);
-    if (zetas_inv_) AVXAllocator::deallocate(zetas_inv_);
     if (bitrev_) AVXAllocator::deallocate(bitrev_);
-#ifdef HAVE_AVX512
-    if (zetas_avx512_) AVXAllocator::deallocate(zetas_avx512_);
-    if (zetas_inv_avx512_) AVXAllocator::deallocate(zetas_inv_avx512_);
-#endif
 }
 
 void AVXNTTEngine::precompute_zetas() {
-    uint32_t g = 3;
-    uint32_t zeta = mod_pow(g, (q_ - 1) / n_, q_);
-
     uint32_t* zetas = reinterpret_cast<uint32_t*>(zetas_);
-    zetas[0] = 1;
-    for (uint32_t i = 1; i < n_; ++i) {
-        zetas[i] = (static_cast<uint64_t>(zetas[i-1]) * zeta) % q_;
+    std::fill(zetas, zetas + n_, 0);
+
+    uint32_t blocks = 1u << layers_;
+    base_roots_.assign(blocks, 0);
+    uint32_t scale = 1;
+    if (layers_ == 0) {
+        base_roots_[0] = q_ - 1;  // X^n + 1 = X^n - (-1)
+    } else {
+        // psi is a primitive 2^(layers + 1)-th root of unity
+        uint32_t g = find_generator(q_);
+        uint32_t psi = mod_pow(g, (q_ - 1) >> (layers_ + 1), q_);
+
+        for (uint32_t i = 0; i < blocks; ++i) {
+            zetas[i] = mod_pow(psi, bit_reverse_bits(i, layers_), q_);
+            base_roots_[i] = mod_pow(psi, 2 * bit_reverse_bits(i, layers_) + 1, q_);
+        }
+        scale = mod_inverse(blocks % q_, q_);
     }
-
-    uint32_t zeta_inv = mod_inverse(zeta, q_);
-    uint32_t* zetas_inv = reinterpret_cast<uint32_t*>(zetas_inv_);
-    zetas_inv[0] = 1;
-    for (uint32_t i = 1; i < n_; ++i) {
-        zetas_inv[i] = (static_cast<uint64_t>(zetas_inv[i-1]) * zeta_inv) % q_;
+    if (base_degree_ == 2) {
+        base_root_pairs_.assign(n_, 1);
+        for (uint32_t i = 0; i < blocks; ++i) {
+            base_root_pairs_[2 * i + 1] = base_roots_[i];
+        }
     }
+    inv_scale_ = scale;
 
-#ifdef HAVE_AVX512
-    uint32_t* zetas_avx512 = reinterpret_cast<uint32_t*>(zetas_avx512_);
-    uint32_t* zetas_inv_avx512 = reinterpret_cast<uint32_t*>(zetas_inv_avx512_);
-
-    for (uint32_t i = 0; i < n_; ++i) {
-        zetas_avx512[i] = zetas[i];
-        zetas_inv_avx512[i] = zetas_inv[i];
+    if (strategy_ == ReductionStrategy::Montgomery || strategy_ == ReductionStrategy::SpecialForm) {
+        for (uint32_t i = 0; i < blocks; ++i) {
+            zetas[i] = montgomery_.to_montgomery(zetas[i]);
+        }
+        inv_scale_ = montgomery_.to_montgomery(scale);
+    } else if (strategy_ == ReductionStrategy::Shoup) {
+        zetas_shoup_.assign(blocks, 0);
+        for (uint32_t i = 0; i < blocks; ++i) {
+            zetas_shoup_[i] = ShoupMultiplier::precompute(zetas[i], q_);
+        }
+        inv_scale_shoup_ = ShoupMultiplier::precompute(scale, q_);
     }
-#endif
 }
 
 void AVXNTTEngine::precompute_bitrev() {
     for (uint32_t i = 0; i < n_; ++i) {
-        uint32_t rev = 0;
-        for (uint32_t j = 0; j < log_n_; ++j) {
-            rev |= ((i >> j) & 1) << (log_n_ - 1 - j);
-        }
-        bitrev_[i] = rev;
+        bitrev_[i] = bit_reverse_bits(i, log_n_);
     }
 }
 
-void AVXNTTEngine::butterfly_avx(__m256i& a, __m256i& b, __m256i zeta) const {
-    uint32_t* a_vals = reinterpret_cast<uint32_t*>(&a);
-    uint32_t* b_vals = reinterpret_cast<uint32_t*>(&b);
-    uint32_t* zeta_vals = reinterpret_cast<uint32_t*>(&zeta);
+template<typename F>
+void AVXNTTEngine::with_kernels(F&& f) const {
+    using RS = ReductionStrategy;
+    using NoModulus = std::integral_constant<uint32_t, 0>;
+    auto with_tier = [&](auto s, auto q) {
+        switch (tier_) {
+#ifdef HAVE_AVX512
+            case KernelTier::AVX512:
+                f(s, q, std::integral_constant<KernelTier, KernelTier::AVX512>());
+                break;
+#endif
+#ifdef HAVE_AVX2
+            case KernelTier::AVX2:
+                f(s, q, std::integral_constant<KernelTier, KernelTier::AVX2>());
+                break;
+#endif
+            default:
+                f(s, q, std::integral_constant<KernelTier, KernelTier::Scalar>());
+                break;
+        }
+    };
+    switch (strategy_) {
+        case RS::Barrett:
+            with_tier(std::integral_constant<RS, RS::Barrett>(), NoModulus());
+            break;
+        case RS::Shoup:
+            with_tier(std::integral_constant<RS, RS::Shoup>(), NoModulus());
+            break;
+        case RS::SpecialForm:
+            dispatch_special_form(q_, [&](auto q) { with_tier(std::integral_constant<RS, RS::SpecialForm>(), q); });
+            break;
+        default:
+            with_tier(std::integral_constant<RS, RS::Montgomery>(), NoModulus());
+            break;
+    }
+}
 
-    for (int i = 0; i < 8; ++i) {
-        uint32_t sum = (a_vals[i] + b_vals[i]) % q_;
-        uint32_t diff = (a_vals[i] >= b_vals[i]) ? (a_vals[i] - b_vals[i]) : (a_vals[i] + q_ - b_vals[i]);
-        uint32_t prod = (static_cast<uint64_t>(diff) * zeta_vals[i]) % q_;
-        a_vals[i] = sum;
-        b_vals[i] = prod;
+template<ReductionStrategy S, uint32_t Q, typename Lane>
+Lane AVXNTTEngine::twiddle_mul(Lane a, Lane zeta, Lane zeta_shoup) const {
+    if constexpr (S == ReductionStrategy::Montgomery) {
+        return montgomery_.mul(a, zeta);
+    } else if constexpr (S == ReductionStrategy::SpecialForm) {
+        return SpecialFormReducer<Q>::mul(a, zeta);
+    } else if constexpr (S == ReductionStrategy::Barrett) {
+        return barrett_.mul(a, zeta);
+    } else {
+        return ShoupMultiplier::mul(a, zeta, zeta_shoup, LaneOps<Lane>::set1(q_));
     }
 }
 
-void AVXNTTEngine::butterfly_inv_avx(__m256i& a, __m256i& b, __m256i zeta) const {
-    butterfly_avx(a, b, zeta);
+template<ReductionStrategy S, uint32_t Q, typename Lane>
+Lane AVXNTTEngine::mul(Lane a, Lane b) const {
+    const Lane r2 = LaneOps<Lane>::set1(montgomery_.r2());
+    if constexpr (S == ReductionStrategy::Montgomery) {
+        // mont(mont(a, b), R^2) = a * b
+        return montgomery_.mul(montgomery_.mul(a, b), r2);
+    } else if constexpr (S == ReductionStrategy::SpecialForm) {
+        return SpecialFormReducer<Q>::mul(SpecialFormReducer<Q>::mul(a, b), r2);
+    } else {
+        // Shoup needs a constant operand, so variable products use Barrett
+        return barrett_.mul(a, b);
+    }
 }
 
-__m256i AVXNTTEngine::mod_reduce_avx(__m256i val) const {
-    uint32_t* vals = reinterpret_cast<uint32_t*>(&val);
-    for (int i = 0; i < 8; ++i) {
-        if (vals[i] >= q_) {
-            vals[i] -= q_;
-        }
+// Cooley-Tukey: (a, b) -> (a + zeta*b, a - zeta*b)
+template<ReductionStrategy S, uint32_t Q, typename Lane>
+void AVXNTTEngine::butterfly_block(uint32_t* coeffs, uint32_t len, uint32_t zeta, uint32_t zeta_shoup) const {
+    using L = LaneOps<Lane>;
+    const Lane q_vec = L::set1(q_);
+    const Lane zeta_vec = L::set1(zeta);
+    const Lane shoup_vec = L::set1(zeta_shoup);
+    for (uint32_t j = 0; j < len; j += L::width) {
+        Lane a = L::load(coeffs + j);
+        Lane t = twiddle_mul<S, Q>(L::load(coeffs + j + len), zeta_vec, shoup_vec);
+        L::store(coeffs + j + len, L::csub(L::sub(L::add(a, q_vec), t), q_vec));
+        L::store(coeffs + j, L::csub(L::add(a, t), q_vec));
     }
-    return val;
 }
 
-void AVXNTTEngine::butterfly_avx512(avx512_int& a, avx512_int& b, avx512_int zeta) const {
-#ifdef HAVE_AVX512
-    avx512_int sum = _mm512_add_epi32(a, b);
-    avx512_int diff = _mm512_sub_epi32(a, b);
-    avx512_int prod = _mm512_mullo_epi32(diff, zeta);
-    prod = mod_reduce_avx512(prod);
-    a = sum;
-    b = prod;
-#else
-    uint32_t* a_vals = reinterpret_cast<uint32_t*>(&a);
-    uint32_t* b_vals = reinterpret_cast<uint32_t*>(&b);
-    uint32_t* zeta_vals = reinterpret_cast<uint32_t*>(&zeta);
-
-    for (int i = 0; i < 16; ++i) {
-        uint32_t sum = (a_vals[i] + b_vals[i]) % q_;
-        uint32_t diff = (a_vals[i] >= b_vals[i]) ? (a_vals[i] - b_vals[i]) : (a_vals[i] + q_ - b_vals[i]);
-        uint32_t prod = (static_cast<uint64_t>(diff) * zeta_vals[i]) % q_;
-        a_vals[i] = sum;
-        b_vals[i] = prod;
+// Gentleman-Sande: (a, b) -> (a + b, zeta*(b - a))
+template<ReductionStrategy S, uint32_t Q, typename Lane>
+void AVXNTTEngine::butterfly_inv_block(uint32_t* coeffs, uint32_t len, uint32_t zeta, uint32_t zeta_shoup) const {
+    using L = LaneOps<Lane>;
+    const Lane q_vec = L::set1(q_);
+    const Lane zeta_vec = L::set1(zeta);
+    const Lane shoup_vec = L::set1(zeta_shoup);
+    for (uint32_t j = 0; j < len; j += L::width) {
+        Lane a = L::load(coeffs + j);
+        Lane b = L::load(coeffs + j + len);
+        L::store(coeffs + j, L::csub(L::add(a, b), q_vec));
+        L::store(coeffs + j + len, twiddle_mul<S, Q>(L::csub(L::sub(L::add(b, q_vec), a), q_vec), zeta_vec, shoup_vec));
     }
-#endif
 }
 
-void AVXNTTEngine::butterfly_inv_avx512(avx512_int& a, avx512_int& b, avx512_int zeta) const {
-    butterfly_avx512(a, b, zeta);
+template<ReductionStrategy S, uint32_t Q, typename Lane>
+void AVXNTTEngine::scale_lanes(uint32_t* coeffs) const {
+    using L = LaneOps<Lane>;
+    const Lane scale_vec = L::set1(inv_scale_);
+    const Lane scale_shoup_vec = L::set1(inv_scale_shoup_);
+    for (uint32_t i = 0; i < n_; i += L::width) {
+        L::store(coeffs + i, twiddle_mul<S, Q>(L::load(coeffs + i), scale_vec, scale_shoup_vec));
+    }
 }
 
-avx512_int AVXNTTEngine::mod_reduce_avx512(avx512_int val) const {
-#ifdef HAVE_AVX512
-    return montgomery_reduce_avx512(val);
-#else
-    uint32_t* vals = reinterpret_cast<uint32_t*>(&val);
-    for (int i = 0; i < 16; ++i) {
-        if (vals[i] >= q_) {
-            vals[i] -= q_;
+// Blocks narrower than a vector fall back to the next narrower lane type
+template<ReductionStrategy S, uint32_t Q, KernelTier T>
+void AVXNTTEngine::ntt_forward_impl(uint32_t* coeffs) const {
+    const uint32_t* zetas = reinterpret_cast<const uint32_t*>(zetas_);
+    uint32_t k = 0;
+
+    for (uint32_t len = n_ / 2; len >= base_degree_ && layers_ > 0; len >>= 1) {
+        for (uint32_t start = 0; start < n_; start += 2 * len) {
+            ++k;
+            uint32_t zeta = zetas[k];
+            uint32_t zeta_shoup = S == ReductionStrategy::Shoup ? zetas_shoup_[k] : 0;
+            if (T == KernelTier::AVX512 && len >= 16) {
+                butterfly_block<S, Q, avx512_int>(coeffs + start, len, zeta, zeta_shoup);
+            } else if (T != KernelTier::Scalar && len >= 8) {
+                butterfly_block<S, Q, __m256i>(coeffs + start, len, zeta, zeta_shoup);
+            } else {
+                butterfly_block<S, Q, uint32_t>(coeffs + start, len, zeta, zeta_shoup);
+            }
         }
     }
-    return val;
-#endif
 }
 
-uint32_t AVXNTTEngine::montgomery_reduce(uint64_t val) const {
-    uint64_t t = val * montgomery_r_inv_;
-    uint32_t k = t % (1ULL << 32);
-    uint64_t res = val - static_cast<uint64_t>(k) * q_;
-    return res >> 32;
-}
+template<ReductionStrategy S, uint32_t Q, KernelTier T>
+void AVXNTTEngine::ntt_inverse_impl(uint32_t* coeffs) const {
+    const uint32_t* zetas = reinterpret_cast<const uint32_t*>(zetas_);
+    uint32_t k = 1u << layers_;
+
+    for (uint32_t len = base_degree_; len <= n_ / 2 && layers_ > 0; len <<= 1) {
+        for (uint32_t start = 0; start < n_; start += 2 * len) {
+            --k;
+            uint32_t zeta = zetas[k];
+            uint32_t zeta_shoup = S == ReductionStrategy::Shoup ? zetas_shoup_[k] : 0;
+            if (T == KernelTier::AVX512 && len >= 16) {
+                butterfly_inv_block<S, Q, avx512_int>(coeffs + start, len, zeta, zeta_shoup);
+            } else if (T != KernelTier::Scalar && len >= 8) {
+                butterfly_inv_block<S, Q, __m256i>(coeffs + start, len, zeta, zeta_shoup);
+            } else {
+                butterfly_inv_block<S, Q, uint32_t>(coeffs + start, len, zeta, zeta_shoup);
+            }
+        }
+    }
 
-__m256i AVXNTTEngine::montgomery_reduce_avx(__m256i val) const {
-#ifdef HAVE_AVX2
-    __m256i r_inv_vec = _mm256_set1_epi32(montgomery_r_inv_);
-    __m256i prod = _mm256_mullo_epi32(val, r_inv_vec);
-    __m256i k = _mm256_and_si256(prod, _mm256_set1_epi32(0xFFFFFFFF));
-    __m256i q_vec = _mm256_set1_epi32(q_);
-    __m256i kq = _mm256_mullo_epi32(k, q_vec);
-    __m256i diff = _mm256_sub_epi32(val, kq);
-    return _mm256_srli_epi32(diff, 32);
-#else
-    uint32_t* vals = reinterpret_cast<uint32_t*>(&val);
-    for (int i = 0; i < 8; ++i) {
-        vals[i] = montgomery_reduce(vals[i]);
+    if (T == KernelTier::AVX512 && n_ >= 16) {
+        scale_lanes<S, Q, avx512_int>(coeffs);
+    } else if (T != KernelTier::Scalar) {
+        scale_lanes<S, Q, __m256i>(coeffs);
+    } else {
+        scale_lanes<S, Q, uint32_t>(coeffs);
     }
-    return val;
-#endif
 }
 
-avx512_int AVXNTTEngine::montgomery_reduce_avx512(avx512_int val) const {
-#ifdef HAVE_AVX512
-    avx512_int r_inv_vec = _mm512_set1_epi32(montgomery_r_inv_);
-    avx512_int prod = _mm512_mullo_epi32(val, r_inv_vec);
-    avx512_int k = _mm512_and_epi32(prod, _mm512_set1_epi32(0xFFFFFFFF));
-    avx512_int q_vec = _mm512_set1_epi32(q_);
-    avx512_int kq = _mm512_mullo_epi32(k, q_vec);
-    avx512_int diff = _mm512_sub_epi32(val, kq);
-    return _mm512_srli_epi32(diff, 32);
-#else
-    uint32_t* vals = reinterpret_cast<uint32_t*>(&val);
-    for (int i = 0; i < 16; ++i) {
-        vals[i] = montgomery_reduce(vals[i]);
+template<ReductionStrategy S, uint32_t Q, typename Lane>
+void AVXNTTEngine::pointwise_degree1(const uint32_t* a, const uint32_t* b, uint32_t* result, bool accumulate) const {
+    using L = LaneOps<Lane>;
+    const Lane q_vec = L::set1(q_);
+    for (uint32_t i = 0; i < n_; i += L::width) {
+        Lane prod = mul<S, Q>(L::load(a + i), L::load(b + i));
+        L::store(result + i, accumulate ? L::csub(L::add(L::load(result + i), prod), q_vec) : prod);
     }
-    return val;
-#endif
 }
 
-void AVXNTTEngine::ntt_forward_avx(__m256i* poly) const {
-    uint32_t* zetas = reinterpret_cast<uint32_t*>(zetas_);
-    uint32_t m = 1;
-    uint32_t k = n_ / 2;
-
-    for (uint32_t stage = 0; stage < log_n_; ++stage) {
-        uint32_t j = 0;
-        for (uint32_t i = 0; i < k; ++i) {
-            uint32_t zeta = zetas[j];
-            __m256i zeta_vec;
-            uint32_t* zeta_ptr = reinterpret_cast<uint32_t*>(&zeta_vec);
-            for (int x = 0; x < 8; ++x) zeta_ptr[x] = zeta;
-            butterfly_avx(poly[i], poly[i + k], zeta_vec);
-            j += m;
-        }
-        m *= 2;
-        k /= 2;
+// (a0 + a1 X)(b0 + b1 X) mod X^2 - gamma is (a0 b0 + gamma a1 b1) + (a0 b1 + a1 b0) X,
+// with width / 2 residues per vector
+template<ReductionStrategy S, uint32_t Q, typename Lane>
+void AVXNTTEngine::pointwise_degree2(const uint32_t* a, const uint32_t* b, uint32_t* result, bool accumulate) const {
+    using L = LaneOps<Lane>;
+    const Lane q_vec = L::set1(q_);
+    const uint32_t* gammas = base_root_pairs_.data();
+    for (uint32_t i = 0; i < n_; i += L::width) {
+        Lane x = L::load(a + i);
+        Lane y = L::load(b + i);
+        Lane even = mul<S, Q>(mul<S, Q>(x, y), L::load(gammas + i));
+        Lane odd = mul<S, Q>(x, swap_pairs(y));
+        Lane prod = L::csub(interleave_pairs(L::add(even, swap_pairs(even)), L::add(odd, swap_pairs(odd))), q_vec);
+        L::store(result + i, accumulate ? L::csub(L::add(L::load(result + i), prod), q_vec) : prod);
     }
 }
 
-void AVXNTTEngine::ntt_inverse_avx(__m256i* poly) const {
-    uint32_t* zetas_inv = reinterpret_cast<uint32_t*>(zetas_inv_);
-    uint32_t m = n_ / 2;
-    uint32_t k = 1;
-
-    for (uint32_t stage = 0; stage < log_n_; ++stage) {
-        uint32_t j = 0;
-        for (uint32_t i = 0; i < k; ++i) {
-            uint32_t zeta = zetas_inv[j];
-            __m256i zeta_vec;
-            uint32_t* zeta_ptr = reinterpret_cast<uint32_t*>(&zeta_vec);
-            for (int x = 0; x < 8; ++x) zeta_ptr[x] = zeta;
-            butterfly_inv_avx(poly[i], poly[i + k], zeta_vec);
-            j += m;
+// Residues modulo X^d - gamma_i: schoolbook product with wrap-around by gamma_i
+template<ReductionStrategy S, uint32_t Q>
+void AVXNTTEngine::pointwise_schoolbook(const uint32_t* a, const uint32_t* b, uint32_t* result, bool accumulate) const {
+    using L = LaneOps<uint32_t>;
+    const uint32_t d = base_degree_;
+    AlignedVector<uint32_t> acc(2 * d);
+
+    for (uint32_t blk = 0; blk < n_ / d; ++blk) {
+        const uint32_t* x = a + blk * d;
+        const uint32_t* y = b + blk * d;
+        std::fill(acc.begin(), acc.end(), 0);
+        for (uint32_t i = 0; i < d; ++i) {
+            for (uint32_t j = 0; j < d; ++j) {
+                acc[i + j] = L::csub(acc[i + j] + mul<S, Q>(x[i], y[j]), q_);
+            }
+        }
+        uint32_t gamma = base_roots_[blk];
+        for (uint32_t i = 0; i < d; ++i) {
+            uint32_t r = L::csub(acc[i] + mul<S, Q>(acc[i + d], gamma), q_);
+            result[blk * d + i] = accumulate ? L::csub(result[blk * d + i] + r, q_) : r;
         }
-        m /= 2;
-        k *= 2;
     }
+}
 
-    uint32_t n_inv = mod_inverse(n_, q_);
-    for (uint32_t i = 0; i < n_/8; ++i) {
-        uint32_t* poly_ptr = reinterpret_cast<uint32_t*>(&poly[i]);
-        for (int x = 0; x < 8; ++x) {
-            poly_ptr[x] = (static_cast<uint64_t>(poly_ptr[x]) * n_inv) % q_;
+template<ReductionStrategy S, uint32_t Q, KernelTier T>
+void AVXNTTEngine::pointwise_impl(const uint32_t* a, const uint32_t* b, uint32_t* result, bool accumulate) const {
+    if (base_degree_ == 1) {
+        if (T == KernelTier::AVX512 && n_ >= 16) {
+            pointwise_degree1<S, Q, avx512_int>(a, b, result, accumulate);
+        } else if (T != KernelTier::Scalar) {
+            pointwise_degree1<S, Q, __m256i>(a, b, result, accumulate);
+        } else {
+            pointwise_degree1<S, Q, uint32_t>(a, b, result, accumulate);
+        }
+    } else if (base_degree_ == 2 && T != KernelTier::Scalar) {
+        if (T == KernelTier::AVX512 && n_ >= 16) {
+            pointwise_degree2<S, Q, avx512_int>(a, b, result, accumulate);
+        } else {
+            pointwise_degree2<S, Q, __m256i>(a, b, result, accumulate);
         }
+    } else {
+        pointwise_schoolbook<S, Q>(a, b, result, accumulate);
     }
 }
 
+// The strategy and tier are fixed per engine, so dispatch once per call
+void AVXNTTEngine::ntt_forward_avx(__m256i* poly) const {
+    CLWE_INSTRUMENT(NTTForward);
+    uint32_t* coeffs = reinterpret_cast<uint32_t*>(poly);
+    with_kernels([&](auto s, auto q, auto t) {
+        ntt_forward_impl<decltype(s)::value, decltype(q)::value, decltype(t)::value>(coeffs);
+    });
+}
+
+void AVXNTTEngine::ntt_inverse_avx(__m256i* poly) const {
+    CLWE_INSTRUMENT(NTTInverse);
+    uint32_t* coeffs = reinterpret_cast<uint32_t*>(poly);
+    with_kernels([&](auto s, auto q, auto t) {
+        ntt_inverse_impl<decltype(s)::value, decltype(q)::value, decltype(t)::value>(coeffs);
+    });
+}
+
+void AVXNTTEngine::pointwise_multiply_avx(const __m256i* a, const __m256i* b, __m256i* result) const {
+    CLWE_INSTRUMENT(PointwiseMultiply);
+    with_kernels([&](auto s, auto q, auto t) {
+        pointwise_impl<decltype(s)::value, decltype(q)::value, decltype(t)::value>(
+            reinterpret_cast<const uint32_t*>(a), reinterpret_cast<const uint32_t*>(b),
+            reinterpret_cast<uint32_t*>(result), false);
+    });
+}
+
+void AVXNTTEngine::pointwise_multiply_acc_avx(const __m256i* a, const __m256i* b, __m256i* result) const {
+    CLWE_INSTRUMENT(PointwiseMultiply);
+    with_kernels([&](auto s, auto q, auto t) {
+        pointwise_impl<decltype(s)::value, decltype(q)::value, decltype(t)::value>(
+            reinterpret_cast<const uint32_t*>(a), reinterpret_cast<const uint32_t*>(b),
+            reinterpret_cast<uint32_t*>(result), true);
+    });
+}
+
 void AVXNTTEngine::ntt_forward_avx512(avx512_int* poly) const {
-#ifdef HAVE_AVX512
-    uint32_t m = 1;
-    uint32_t k = n_ / 2;
-
-    for (uint32_t stage = 0; stage < log_n_; ++stage) {
-        uint32_t j = 0;
-        for (uint32_t i = 0; i < k; i += 16) {
-            avx512_int zeta_vec = _mm512_loadu_si512(&zetas_avx512_[j]);
-            butterfly_avx512(poly[i/16], poly[(i + k)/16], zeta_vec);
-            j += m;
-        }
-        m *= 2;
-        k /= 2;
-    }
-#else
     ntt_forward_avx(reinterpret_cast<__m256i*>(poly));
-#endif
 }
 
 void AVXNTTEngine::ntt_inverse_avx512(avx512_int* poly) const {
-#ifdef HAVE_AVX512
-    uint32_t m = n_ / 2;
-    uint32_t k = 1;
-
-    for (uint32_t stage = 0; stage < log_n_; ++stage) {
-        uint32_t j = 0;
-        for (uint32_t i = 0; i < k; i += 16) {
-            avx512_int zeta_vec = _mm512_loadu_si512(&zetas_inv_avx512_[j]);
-            butterfly_inv_avx512(poly[i/16], poly[(i + k)/16], zeta_vec);
-            j += m;
-        }
-        m /= 2;
-        k *= 2;
-    }
-
-    avx512_int n_inv_vec = _mm512_set1_epi32(mod_inverse(n_, q_));
-    for (uint32_t i = 0; i < n_/16; ++i) {
-        poly[i] = _mm512_mullo_epi32(poly[i], n_inv_vec);
-        poly[i] = mod_reduce_avx512(poly[i]);
-    }
-#else
     ntt_inverse_avx(reinterpret_cast<__m256i*>(poly));
-#endif
 }
 
 void AVXNTTEngine::multiply_avx(const __m256i* a, const __m256i* b, __m256i* result) const {
@@ -333,14 +463,7 @@ void AVXNTTEngine::multiply_avx(const __m256i* a, const __m256i* b, __m256i* res
     ntt_forward_avx(a_ntt);
     ntt_forward_avx(b_ntt);
 
-    for (uint32_t i = 0; i < n_/8; ++i) {
-        uint32_t* a_ptr = reinterpret_cast<uint32_t*>(&a_ntt[i]);
-        uint32_t* b_ptr = reinterpret_cast<uint32_t*>(&b_ntt[i]);
-        uint32_t* r_ptr = reinterpret_cast<uint32_t*>(&result[i]);
-        for (int j = 0; j < 8; ++j) {
-            r_ptr[j] = montgomery_reduce(static_cast<uint64_t>(a_ptr[j]) * b_ptr[j]);
-        }
-    }
+    pointwise_multiply_avx(a_ntt, b_ntt, result);
 
     ntt_inverse_avx(result);
 
@@ -349,29 +472,8 @@ void AVXNTTEngine::multiply_avx(const __m256i* a, const __m256i* b, __m256i* res
 }
 
 void AVXNTTEngine::multiply_avx512(const avx512_int* a, const avx512_int* b, avx512_int* result) const {
-#ifdef HAVE_AVX512
-    avx512_int* a_ntt = static_cast<avx512_int*>(AVXAllocator::allocate(n_/16 * sizeof(avx512_int)));
-    avx512_int* b_ntt = static_cast<avx512_int*>(AVXAllocator::allocate(n_/16 * sizeof(avx512_int)));
-
-    memcpy(a_ntt, a, n_/16 * sizeof(avx512_int));
-    memcpy(b_ntt, b, n_/16 * sizeof(avx512_int));
-
-    ntt_forward_avx512(a_ntt);
-    ntt_forward_avx512(b_ntt);
-
-    for (uint32_t i = 0; i < n_/16; ++i) {
-        result[i] = _mm512_mullo_epi32(a_ntt[i], b_ntt[i]);
-        result[i] = montgomery_reduce_avx512(result[i]);
-    }
-
-    ntt_inverse_avx512(result);
-
-    AVXAllocator::deallocate(a_ntt);
-    AVXAllocator::deallocate(b_ntt);
-#else
     multiply_avx(reinterpret_cast<const __m256i*>(a), reinterpret_cast<const __m256i*>(b),
                  reinterpret_cast<__m256i*>(result));
-#endif
 }
 
 void AVXNTTEngine::bit_reverse_avx(__m256i* poly) const {
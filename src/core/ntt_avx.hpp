@@ -2,6 +2,8 @@
 #define NTT_AVX_HPP
 
 #include "utils.hpp"
+#include "modular_reduction.hpp"
+#include "kernel_dispatch.hpp"
 #include <cstdint>
 #include <vector>
 
@@ -14,39 +16,77 @@ typedef __m256i avx512_int;
 
 namespace clwe {
 
+// Negacyclic NTT over Z_q[X]/(X^n + 1) for odd q < 2^31.
+//
+// Coefficients are kept in [0, q) in the natural order used by AVXPolynomial.
+// When q - 1 is not divisible by 2n the transform is incomplete (as for
+// q = 3329, n = 256) and stops at residue polynomials of degree base_degree(),
+// which pointwise_multiply_avx multiplies modulo X^d - gamma_i.
+//
+// The reduction strategy picks how twiddle and pointwise products are reduced;
+// all strategies produce identical results. The kernel tier (scalar, 8-lane
+// AVX2 or 16-lane AVX-512) defaults to active_kernel_tier() at construction
+// and is lowered to what the host supports.
 class AVXNTTEngine {
 private:
     uint32_t q_;
     uint32_t n_;
     uint32_t log_n_;
-    __m256i* zetas_;
-    __m256i* zetas_inv_;
+    __m256i* zetas_;       // psi^brv(i), in Montgomery form for Montgomery and SpecialForm
+    AlignedVector<uint32_t> zetas_shoup_;  // Shoup quotients of zetas_ (Shoup strategy only)
     uint32_t* bitrev_;
 
-    avx512_int* zetas_avx512_;
-    avx512_int* zetas_inv_avx512_;
+    uint32_t layers_;          // Number of butterfly layers
+    uint32_t base_degree_;     // Degree of the residue polynomials after the transform
+    std::vector<uint32_t> base_roots_;  // gamma_i of X^d - gamma_i, plain form
+    AlignedVector<uint32_t> base_root_pairs_;  // (1, gamma_i) per residue when d = 2
 
-    uint32_t montgomery_r_;
-    uint32_t montgomery_r_inv_;
+    ReductionStrategy strategy_;
+    KernelTier tier_;
+    MontgomeryReducer montgomery_;
+    BarrettReducer barrett_;   // Barrett and Shoup strategies (q < 2^30)
+    uint32_t inv_scale_;       // (n/d)^(-1), in the same form as zetas_
+    uint32_t inv_scale_shoup_;
 
     void precompute_zetas();
     void precompute_bitrev();
 
-    void butterfly_avx(__m256i& a, __m256i& b, __m256i zeta) const;
-    void butterfly_inv_avx(__m256i& a, __m256i& b, __m256i zeta) const;
-
-    void butterfly_avx512(avx512_int& a, avx512_int& b, avx512_int zeta) const;
-    void butterfly_inv_avx512(avx512_int& a, avx512_int& b, avx512_int zeta) const;
-
-    __m256i mod_reduce_avx(__m256i val) const;
-    avx512_int mod_reduce_avx512(avx512_int val) const;
-
-    uint32_t montgomery_reduce(uint64_t val) const;
-    __m256i montgomery_reduce_avx(__m256i val) const;
-    avx512_int montgomery_reduce_avx512(avx512_int val) const;
+    // Calls f(strategy, modulus, tier) with all three as integral constants;
+    // the modulus is 0 unless the strategy is SpecialForm
+    template<typename F>
+    void with_kernels(F&& f) const;
+
+    // zeta * a mod q under strategy S; zeta_shoup is only read by Shoup
+    template<ReductionStrategy S, uint32_t Q, typename Lane>
+    Lane twiddle_mul(Lane a, Lane zeta, Lane zeta_shoup) const;
+    // a * b mod q for fully reduced lanes
+    template<ReductionStrategy S, uint32_t Q, typename Lane>
+    Lane mul(Lane a, Lane b) const;
+
+    // One butterfly block of span len, a lane at a time (len is a multiple of the width)
+    template<ReductionStrategy S, uint32_t Q, typename Lane>
+    void butterfly_block(uint32_t* coeffs, uint32_t len, uint32_t zeta, uint32_t zeta_shoup) const;
+    template<ReductionStrategy S, uint32_t Q, typename Lane>
+    void butterfly_inv_block(uint32_t* coeffs, uint32_t len, uint32_t zeta, uint32_t zeta_shoup) const;
+    template<ReductionStrategy S, uint32_t Q, typename Lane>
+    void scale_lanes(uint32_t* coeffs) const;
+
+    template<ReductionStrategy S, uint32_t Q, KernelTier T>
+    void ntt_forward_impl(uint32_t* coeffs) const;
+    template<ReductionStrategy S, uint32_t Q, KernelTier T>
+    void ntt_inverse_impl(uint32_t* coeffs) const;
+    template<ReductionStrategy S, uint32_t Q, KernelTier T>
+    void pointwise_impl(const uint32_t* a, const uint32_t* b, uint32_t* result, bool accumulate) const;
+    template<ReductionStrategy S, uint32_t Q, typename Lane>
+    void pointwise_degree1(const uint32_t* a, const uint32_t* b, uint32_t* result, bool accumulate) const;
+    template<ReductionStrategy S, uint32_t Q, typename Lane>
+    void pointwise_degree2(const uint32_t* a, const uint32_t* b, uint32_t* result, bool accumulate) const;
+    template<ReductionStrategy S, uint32_t Q>
+    void pointwise_schoolbook(const uint32_t* a, const uint32_t* b, uint32_t* result, bool accumulate) const;
 
 public:
-    AVXNTTEngine(uint32_t q, uint32_t n);
+    AVXNTTEngine(uint32_t q, uint32_t n, ReductionStrategy strategy = ReductionStrategy::Montgomery,
+                 KernelTier tier = active_kernel_tier());
     ~AVXNTTEngine();
 
     bool has_avx512() const {
@@ -63,6 +103,12 @@ public:
     void ntt_forward_avx(__m256i* poly) const;
     void ntt_inverse_avx(__m256i* poly) const;
 
+    // Product of two polynomials already in NTT form; result stays in NTT form
+    void pointwise_multiply_avx(const __m256i* a, const __m256i* b, __m256i* result) const;
+    // Accumulating variant: result += a * b (NTT form)
+    void pointwise_multiply_acc_avx(const __m256i* a, const __m256i* b, __m256i* result) const;
+
+    // AVX-512 entry points share the 8-lane kernels (the memory layout is identical)
     void ntt_forward_avx512(avx512_int* poly) const;
     void ntt_inverse_avx512(avx512_int* poly) const;
 
@@ -79,8 +125,11 @@ public:
     uint32_t modulus() const { return q_; }
     uint32_t degree() const { return n_; }
     uint32_t log_degree() const { return log_n_; }
+    uint32_t base_degree() const { return base_degree_; }
+    ReductionStrategy strategy() const { return strategy_; }
+    KernelTier kernel_tier() const { return tier_; }
 };
 
 } // namespace clwe
 
-#endif // NTT_AVX_HPP
\ No newline at end of file
+#endif // NTT_AVX_HPP
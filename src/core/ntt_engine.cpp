@@ -1,5 +1,6 @@
 #include "ntt_engine.hpp"
 #include "cpu_features.hpp"
+#include "kernel_dispatch.hpp"
 #include "ntt_scalar.hpp"
 #include "ntt_neon.hpp"
 #include "ntt_rvv.hpp"
@@ -37,7 +38,7 @@ void NTTEngine::precompute_bitrev() {
 }
 
 void NTTEngine::bit_reverse(uint32_t* poly) const {
-    std::vector<uint32_t> temp(n_);
+    AlignedVector<uint32_t> temp(n_);
     for (uint32_t i = 0; i < n_; ++i) {
         temp[bitrev_[i]] = poly[i];
     }
@@ -61,8 +62,11 @@ class RVVNTTEngine;
 // class VSXNTTEngine;
 
 std::unique_ptr<NTTEngine> create_optimal_ntt_engine(uint32_t q, uint32_t n) {
-    CPUFeatures features = CPUFeatureDetector::detect();
-    return create_ntt_engine(features.max_simd_support, q, n);
+    // A scalar kernel cap applies to every architecture's SIMD engines
+    if (kernel_tier_cap() == KernelTier::Scalar) {
+        return create_ntt_engine(SIMDSupport::NONE, q, n);
+    }
+    return create_ntt_engine(CPUFeatureDetector::cached().max_simd_support, q, n);
 }
 
 std::unique_ptr<NTTEngine> create_ntt_engine(SIMDSupport simd_support, uint32_t q, uint32_t n) {
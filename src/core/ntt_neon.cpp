@@ -8,7 +8,7 @@ namespace clwe {
 
 NEONNTTEngine::NEONNTTEngine(uint32_t q, uint32_t n)
     : NTTEngine(q, n), zetas_(nullptr), zetas_inv_(nullptr),
-      montgomery_r_(0), montgomery_r_inv_(0) {
+      montgomery_(q) {
 
 #ifdef __ARM_NEON
     // NEON: 4 uint32_t per uint32x4_t
@@ -17,10 +17,6 @@ NEONNTTEngine::NEONNTTEngine(uint32_t q, uint32_t n)
     zetas_inv_ = new uint32x4_t[neon_count];
 #endif
 
-    // Pre-compute Montgomery constants
-    montgomery_r_ = (1ULL << 32) % q_;
-    montgomery_r_inv_ = mod_inverse(montgomery_r_, q_);
-
     precompute_zetas();
 }
 
@@ -114,10 +110,7 @@ uint32x4_t NEONNTTEngine::mod_reduce_neon(uint32x4_t val) const {
 
 uint32_t NEONNTTEngine::montgomery_reduce(uint64_t val) const {
     // Montgomery reduction: (val * R^-1) mod q
-    uint64_t t = val * montgomery_r_inv_;
-    uint32_t k = t % (1ULL << 32);
-    uint64_t res = val - static_cast<uint64_t>(k) * q_;
-    return res >> 32;
+    return montgomery_.reduce(val);
 }
 
 uint32x4_t NEONNTTEngine::montgomery_reduce_neon(uint32x4_t val) const {
@@ -8,15 +8,11 @@ namespace clwe {
 
 RVVNTTEngine::RVVNTTEngine(uint32_t q, uint32_t n)
     : NTTEngine(q, n), zetas_(nullptr), zetas_inv_(nullptr),
-      montgomery_r_(0), montgomery_r_inv_(0) {
+      montgomery_(q) {
 
     zetas_ = new uint32_t[n];
     zetas_inv_ = new uint32_t[n];
 
-    // Pre-compute Montgomery constants
-    montgomery_r_ = (1ULL << 32) % q_;
-    montgomery_r_inv_ = mod_inverse(montgomery_r_, q_);
-
     precompute_zetas();
 }
 
@@ -88,10 +84,7 @@ void RVVNTTEngine::mod_reduce_rvv(uint32_t* val, size_t vl) const {
 
 uint32_t RVVNTTEngine::montgomery_reduce(uint64_t val) const {
     // Montgomery reduction: (val * R^-1) mod q
-    uint64_t t = val * montgomery_r_inv_;
-    uint32_t k = t % (1ULL << 32);
-    uint64_t res = val - static_cast<uint64_t>(k) * q_;
-    return res >> 32;
+    return montgomery_.reduce(val);
 }
 
 void RVVNTTEngine::montgomery_reduce_rvv(uint32_t* val, size_t vl) const {
@@ -9,11 +9,7 @@ namespace clwe {
 
 ScalarNTTEngine::ScalarNTTEngine(uint32_t q, uint32_t n)
     : NTTEngine(q, n), zetas_(n), zetas_inv_(n),
-      montgomery_r_(0), montgomery_r_inv_(0) {
-
-    // Pre-compute Montgomery constants for modular reduction
-    montgomery_r_ = (1ULL << 32) % q_;
-    montgomery_r_inv_ = mod_inverse(montgomery_r_, q_);
+      montgomery_(q) {
 
     precompute_zetas();
 }
@@ -55,10 +51,7 @@ uint32_t ScalarNTTEngine::mod_reduce(uint32_t val) const {
 
 uint32_t ScalarNTTEngine::montgomery_reduce(uint64_t val) const {
     // Montgomery reduction: (val * R^-1) mod q
-    uint64_t t = val * montgomery_r_inv_;
-    uint32_t k = t % (1ULL << 32);
-    uint64_t res = val - static_cast<uint64_t>(k) * q_;
-    return res >> 32;
+    return montgomery_.reduce(val);
 }
 
 void ScalarNTTEngine::ntt_forward(uint32_t* poly) const {
@@ -103,8 +96,8 @@ void ScalarNTTEngine::ntt_inverse(uint32_t* poly) const {
 
 void ScalarNTTEngine::multiply(const uint32_t* a, const uint32_t* b, uint32_t* result) const {
     // Copy inputs for NTT
-    std::vector<uint32_t> a_ntt(n_);
-    std::vector<uint32_t> b_ntt(n_);
+    AlignedVector<uint32_t> a_ntt(n_);
+    AlignedVector<uint32_t> b_ntt(n_);
     std::copy(a, a + n_, a_ntt.begin());
     std::copy(b, b + n_, b_ntt.begin());
 
@@ -2,6 +2,7 @@
 #define NTT_SCALAR_HPP
 
 #include "ntt_engine.hpp"
+#include "modular_reduction.hpp"
 #include <cstdint>
 #include <vector>
 
@@ -13,8 +14,7 @@ private:
     std::vector<uint32_t> zetas_inv_;   // Inverse zetas
 
     // Montgomery reduction constants
-    uint32_t montgomery_r_;       // 2^32 mod q
-    uint32_t montgomery_r_inv_;   // R^(-1) mod q
+    MontgomeryReducer montgomery_;
 
     // Precompute zetas for NTT
     void precompute_zetas();
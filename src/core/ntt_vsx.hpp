@@ -2,6 +2,7 @@
 #define NTT_VSX_HPP
 
 #include "ntt_engine.hpp"
+#include "modular_reduction.hpp"
 #include <cstdint>
 
 #ifdef __VSX__
@@ -19,8 +20,7 @@ private:
 #endif
 
     // Montgomery reduction constants
-    uint32_t montgomery_r_;       // 2^32 mod q
-    uint32_t montgomery_r_inv_;   // R^(-1) mod q
+    MontgomeryReducer montgomery_;
 
     // Precompute zetas for NTT
     void precompute_zetas();
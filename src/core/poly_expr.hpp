@@ -0,0 +1,430 @@
+#ifndef POLY_EXPR_HPP
+#define POLY_EXPR_HPP
+
+#include "polynomial.hpp"
+#include "modular_reduction.hpp"
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Lazy expression templates for AVXPolynomial and polynomial vectors.
+//
+// An expression such as `r = a + e - c * t` builds a tree of lightweight
+// nodes; assigning it to an AVXPolynomial evaluates the whole tree in a
+// single pass over the coefficient blocks with one final reduction, instead
+// of one full sweep (plus a mod_reduce_avx sweep) per operator.
+//
+// Every node tracks an upper bound on its unreduced lane values in units of
+// q. Additions and subtractions stay lazy while bound * q fits in 32 bits and
+// reduce their operands in-register otherwise; scalar multiplication uses
+// Shoup's precomputed quotient so it never overflows.
+
+namespace clwe {
+
+using PolyVec = std::vector<AVXPolynomial>;
+
+namespace poly_expr_detail {
+
+using Lanes = Avx2Lane;
+
+inline __m256i lane_set1(uint32_t v) { return Lanes::set1(v); }
+inline __m256i lane_add(__m256i a, __m256i b) { return Lanes::add(a, b); }
+inline __m256i lane_sub(__m256i a, __m256i b) { return Lanes::sub(a, b); }
+inline __m256i lane_mullo(__m256i a, __m256i b) { return Lanes::mullo(a, b); }
+// High 32 bits of the unsigned 32x32 product, lane by lane
+inline __m256i lane_mulhi(__m256i a, __m256i b) { return Lanes::mulhi(a, b); }
+// Maps [0, 2q) to [0, q)
+inline __m256i lane_csub(__m256i a, __m256i q) { return Lanes::csub(a, q); }
+
+// Barrett reduction of arbitrary 32-bit lanes to [0, q), m = floor(2^32 / q)
+inline __m256i lane_reduce(__m256i a, __m256i q, __m256i m) {
+    __m256i t = lane_mulhi(a, m);
+    return lane_csub(lane_sub(a, lane_mullo(t, q)), q);
+}
+
+// Reduces a block known to lie in [0, bound * q)
+inline __m256i reduce_bounded(__m256i a, uint32_t bound, __m256i q, __m256i m) {
+    if (bound <= 1) return a;
+    if (bound == 2) return lane_csub(a, q);
+    return lane_reduce(a, q, m);
+}
+
+inline uint32_t barrett_constant(uint32_t q) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(1) << 32) / q);
+}
+
+// True if values below bound * q are representable without wrapping
+inline bool fits_lazy(uint64_t bound, uint32_t q) {
+    return bound * q <= std::numeric_limits<uint32_t>::max();
+}
+
+inline void check_compatible(uint32_t degree_a, uint32_t modulus_a,
+                             uint32_t degree_b, uint32_t modulus_b) {
+    if (degree_a != degree_b || modulus_a != modulus_b) {
+        throw std::invalid_argument("Polynomial expression operands have mismatched degree or modulus");
+    }
+}
+
+} // namespace poly_expr_detail
+
+// CRTP base for lazily evaluated polynomial expressions
+template<typename E>
+class PolyExpr {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// Leaf node referring to an existing, fully reduced polynomial
+class PolyTerminal : public PolyExpr<PolyTerminal> {
+private:
+    const AVXPolynomial& poly_;
+
+public:
+    explicit PolyTerminal(const AVXPolynomial& poly) : poly_(poly) {}
+
+    __m256i block(uint32_t i) const { return poly_.avx_coeffs()[i]; }
+    uint32_t bound() const { return 1; }
+    uint32_t degree() const { return poly_.degree(); }
+    uint32_t modulus() const { return poly_.modulus(); }
+    AVXNTTEngine* ntt_engine() const { return poly_.ntt_engine(); }
+};
+
+template<typename L, typename R>
+class PolyAddExpr : public PolyExpr<PolyAddExpr<L, R>> {
+private:
+    L lhs_;
+    R rhs_;
+    bool reduce_operands_;
+    uint32_t bound_;
+    __m256i q_vec_;
+    __m256i m_vec_;
+
+public:
+    PolyAddExpr(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+        poly_expr_detail::check_compatible(lhs_.degree(), lhs_.modulus(), rhs_.degree(), rhs_.modulus());
+        uint64_t sum = static_cast<uint64_t>(lhs_.bound()) + rhs_.bound();
+        reduce_operands_ = !poly_expr_detail::fits_lazy(sum, modulus());
+        bound_ = reduce_operands_ ? 2 : static_cast<uint32_t>(sum);
+        q_vec_ = poly_expr_detail::lane_set1(modulus());
+        m_vec_ = poly_expr_detail::lane_set1(poly_expr_detail::barrett_constant(modulus()));
+    }
+
+    __m256i block(uint32_t i) const {
+        __m256i a = lhs_.block(i);
+        __m256i b = rhs_.block(i);
+        if (reduce_operands_) {
+            a = poly_expr_detail::reduce_bounded(a, lhs_.bound(), q_vec_, m_vec_);
+            b = poly_expr_detail::reduce_bounded(b, rhs_.bound(), q_vec_, m_vec_);
+        }
+        return poly_expr_detail::lane_add(a, b);
+    }
+
+    uint32_t bound() const { return bound_; }
+    uint32_t degree() const { return lhs_.degree(); }
+    uint32_t modulus() const { return lhs_.modulus(); }
+    AVXNTTEngine* ntt_engine() const { return lhs_.ntt_engine(); }
+};
+
+// a - b is evaluated as a + (bound(b) * q - b) so lanes never go negative
+template<typename L, typename R>
+class PolySubExpr : public PolyExpr<PolySubExpr<L, R>> {
+private:
+    L lhs_;
+    R rhs_;
+    bool reduce_operands_;
+    uint32_t bound_;
+    __m256i offset_vec_;
+    __m256i q_vec_;
+    __m256i m_vec_;
+
+public:
+    PolySubExpr(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+        poly_expr_detail::check_compatible(lhs_.degree(), lhs_.modulus(), rhs_.degree(), rhs_.modulus());
+        uint64_t sum = static_cast<uint64_t>(lhs_.bound()) + rhs_.bound();
+        reduce_operands_ = !poly_expr_detail::fits_lazy(sum, modulus());
+        bound_ = reduce_operands_ ? 2 : static_cast<uint32_t>(sum);
+        uint32_t offset = (reduce_operands_ ? 1 : rhs_.bound()) * modulus();
+        offset_vec_ = poly_expr_detail::lane_set1(offset);
+        q_vec_ = poly_expr_detail::lane_set1(modulus());
+        m_vec_ = poly_expr_detail::lane_set1(poly_expr_detail::barrett_constant(modulus()));
+    }
+
+    __m256i block(uint32_t i) const {
+        __m256i a = lhs_.block(i);
+        __m256i b = rhs_.block(i);
+        if (reduce_operands_) {
+            a = poly_expr_detail::reduce_bounded(a, lhs_.bound(), q_vec_, m_vec_);
+            b = poly_expr_detail::reduce_bounded(b, rhs_.bound(), q_vec_, m_vec_);
+        }
+        return poly_expr_detail::lane_add(a, poly_expr_detail::lane_sub(offset_vec_, b));
+    }
+
+    uint32_t bound() const { return bound_; }
+    uint32_t degree() const { return lhs_.degree(); }
+    uint32_t modulus() const { return lhs_.modulus(); }
+    AVXNTTEngine* ntt_engine() const { return lhs_.ntt_engine(); }
+};
+
+// -b is evaluated as (bound(b) * q - b), which may equal bound(b) * q itself
+template<typename E>
+class PolyNegExpr : public PolyExpr<PolyNegExpr<E>> {
+private:
+    E operand_;
+    bool reduce_operand_;
+    uint32_t bound_;
+    __m256i offset_vec_;
+    __m256i q_vec_;
+    __m256i m_vec_;
+
+public:
+    explicit PolyNegExpr(const E& operand) : operand_(operand) {
+        uint64_t next = static_cast<uint64_t>(operand_.bound()) + 1;
+        reduce_operand_ = !poly_expr_detail::fits_lazy(next, modulus());
+        bound_ = reduce_operand_ ? 2 : static_cast<uint32_t>(next);
+        offset_vec_ = poly_expr_detail::lane_set1((bound_ - 1) * modulus());
+        q_vec_ = poly_expr_detail::lane_set1(modulus());
+        m_vec_ = poly_expr_detail::lane_set1(poly_expr_detail::barrett_constant(modulus()));
+    }
+
+    __m256i block(uint32_t i) const {
+        __m256i b = operand_.block(i);
+        if (reduce_operand_) {
+            b = poly_expr_detail::reduce_bounded(b, operand_.bound(), q_vec_, m_vec_);
+        }
+        return poly_expr_detail::lane_sub(offset_vec_, b);
+    }
+
+    uint32_t bound() const { return bound_; }
+    uint32_t degree() const { return operand_.degree(); }
+    uint32_t modulus() const { return operand_.modulus(); }
+    AVXNTTEngine* ntt_engine() const { return operand_.ntt_engine(); }
+};
+
+// Multiplication by a constant using Shoup's trick: with s' = floor(s * 2^32 / q),
+// a * s - mulhi(a, s') * q lies in [0, 2q) for any 32-bit a.
+template<typename E>
+class PolyScaleExpr : public PolyExpr<PolyScaleExpr<E>> {
+private:
+    E operand_;
+    __m256i scalar_vec_;
+    __m256i shoup_vec_;
+    __m256i q_vec_;
+
+public:
+    PolyScaleExpr(const E& operand, uint32_t scalar) : operand_(operand) {
+        uint32_t s = scalar % modulus();
+        scalar_vec_ = poly_expr_detail::lane_set1(s);
+        shoup_vec_ = poly_expr_detail::lane_set1(ShoupMultiplier::precompute(s, modulus()));
+        q_vec_ = poly_expr_detail::lane_set1(modulus());
+    }
+
+    __m256i block(uint32_t i) const {
+        __m256i a = operand_.block(i);
+        __m256i t = poly_expr_detail::lane_mulhi(a, shoup_vec_);
+        return poly_expr_detail::lane_sub(poly_expr_detail::lane_mullo(a, scalar_vec_),
+                                          poly_expr_detail::lane_mullo(t, q_vec_));
+    }
+
+    uint32_t bound() const { return 2; }
+    uint32_t degree() const { return operand_.degree(); }
+    uint32_t modulus() const { return operand_.modulus(); }
+    AVXNTTEngine* ntt_engine() const { return operand_.ntt_engine(); }
+};
+
+// Operand adaptation: polynomials become terminals, expressions pass through
+inline PolyTerminal as_poly_expr(const AVXPolynomial& poly) { return PolyTerminal(poly); }
+
+template<typename E>
+const E& as_poly_expr(const PolyExpr<E>& expr) { return expr.self(); }
+
+template<typename T>
+using poly_expr_t = typename std::decay<decltype(as_poly_expr(std::declval<const T&>()))>::type;
+
+template<typename T>
+constexpr bool is_poly_operand_v = std::is_same<std::decay_t<T>, AVXPolynomial>::value ||
+                                   std::is_base_of<PolyExpr<std::decay_t<T>>, std::decay_t<T>>::value;
+
+template<typename L, typename R,
+         std::enable_if_t<is_poly_operand_v<L> && is_poly_operand_v<R>, int> = 0>
+PolyAddExpr<poly_expr_t<L>, poly_expr_t<R>> operator+(const L& lhs, const R& rhs) {
+    return PolyAddExpr<poly_expr_t<L>, poly_expr_t<R>>(as_poly_expr(lhs), as_poly_expr(rhs));
+}
+
+template<typename L, typename R,
+         std::enable_if_t<is_poly_operand_v<L> && is_poly_operand_v<R>, int> = 0>
+PolySubExpr<poly_expr_t<L>, poly_expr_t<R>> operator-(const L& lhs, const R& rhs) {
+    return PolySubExpr<poly_expr_t<L>, poly_expr_t<R>>(as_poly_expr(lhs), as_poly_expr(rhs));
+}
+
+template<typename E, std::enable_if_t<is_poly_operand_v<E>, int> = 0>
+PolyNegExpr<poly_expr_t<E>> operator-(const E& operand) {
+    return PolyNegExpr<poly_expr_t<E>>(as_poly_expr(operand));
+}
+
+template<typename E, std::enable_if_t<is_poly_operand_v<E>, int> = 0>
+PolyScaleExpr<poly_expr_t<E>> operator*(uint32_t scalar, const E& operand) {
+    return PolyScaleExpr<poly_expr_t<E>>(as_poly_expr(operand), scalar);
+}
+
+template<typename E, std::enable_if_t<is_poly_operand_v<E>, int> = 0>
+PolyScaleExpr<poly_expr_t<E>> operator*(const E& operand, uint32_t scalar) {
+    return PolyScaleExpr<poly_expr_t<E>>(as_poly_expr(operand), scalar);
+}
+
+// Single fused pass: evaluate every block, reduce once, store
+template<typename E>
+void evaluate_poly_expr(const PolyExpr<E>& expr, __m256i* out) {
+    const E& e = expr.self();
+    const uint32_t blocks = e.degree() / 8;
+    const uint32_t bound = e.bound();
+    const __m256i q_vec = poly_expr_detail::lane_set1(e.modulus());
+    const __m256i m_vec = poly_expr_detail::lane_set1(poly_expr_detail::barrett_constant(e.modulus()));
+
+    for (uint32_t i = 0; i < blocks; ++i) {
+        out[i] = poly_expr_detail::reduce_bounded(e.block(i), bound, q_vec, m_vec);
+    }
+}
+
+template<typename E>
+AVXPolynomial::AVXPolynomial(const PolyExpr<E>& expr)
+    : degree_(expr.self().degree()), modulus_(expr.self().modulus()),
+      coeffs_(nullptr), ntt_(expr.self().ntt_engine()), resource_(current_memory_resource()) {
+    allocate_coeffs();
+    evaluate_poly_expr(expr, coeffs_);
+}
+
+template<typename E>
+AVXPolynomial& AVXPolynomial::operator=(const PolyExpr<E>& expr) {
+    const E& e = expr.self();
+    if (degree_ != e.degree() || modulus_ != e.modulus() || !coeffs_) {
+        // Storage changes shape: evaluate into fresh storage in case the
+        // expression still references our current coefficients
+        *this = AVXPolynomial(expr);
+        return *this;
+    }
+    // Element-wise evaluation reads block i before writing it, so
+    // expressions that alias *this (e.g. p = p + q) are safe
+    evaluate_poly_expr(expr, coeffs_);
+    return *this;
+}
+
+// Polynomial vector expressions: element j of a vector expression is a
+// polynomial expression, so `assign(r, u + e - c * t)` fuses each row.
+template<typename E>
+class PolyVecExpr {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+class PolyVecTerminal : public PolyVecExpr<PolyVecTerminal> {
+private:
+    const PolyVec& vec_;
+
+public:
+    explicit PolyVecTerminal(const PolyVec& vec) : vec_(vec) {}
+
+    size_t size() const { return vec_.size(); }
+    PolyTerminal operator[](size_t j) const { return PolyTerminal(vec_[j]); }
+};
+
+template<typename L, typename R>
+class PolyVecAddExpr : public PolyVecExpr<PolyVecAddExpr<L, R>> {
+private:
+    L lhs_;
+    R rhs_;
+
+public:
+    PolyVecAddExpr(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+        if (lhs_.size() != rhs_.size()) {
+            throw std::invalid_argument("Polynomial vector expression operands have mismatched length");
+        }
+    }
+
+    size_t size() const { return lhs_.size(); }
+    auto operator[](size_t j) const { return lhs_[j] + rhs_[j]; }
+};
+
+template<typename L, typename R>
+class PolyVecSubExpr : public PolyVecExpr<PolyVecSubExpr<L, R>> {
+private:
+    L lhs_;
+    R rhs_;
+
+public:
+    PolyVecSubExpr(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+        if (lhs_.size() != rhs_.size()) {
+            throw std::invalid_argument("Polynomial vector expression operands have mismatched length");
+        }
+    }
+
+    size_t size() const { return lhs_.size(); }
+    auto operator[](size_t j) const { return lhs_[j] - rhs_[j]; }
+};
+
+template<typename E>
+class PolyVecScaleExpr : public PolyVecExpr<PolyVecScaleExpr<E>> {
+private:
+    E operand_;
+    uint32_t scalar_;
+
+public:
+    PolyVecScaleExpr(const E& operand, uint32_t scalar) : operand_(operand), scalar_(scalar) {}
+
+    size_t size() const { return operand_.size(); }
+    auto operator[](size_t j) const { return scalar_ * operand_[j]; }
+};
+
+inline PolyVecTerminal as_poly_vec_expr(const PolyVec& vec) { return PolyVecTerminal(vec); }
+
+template<typename E>
+const E& as_poly_vec_expr(const PolyVecExpr<E>& expr) { return expr.self(); }
+
+template<typename T>
+using poly_vec_expr_t = typename std::decay<decltype(as_poly_vec_expr(std::declval<const T&>()))>::type;
+
+template<typename T>
+constexpr bool is_poly_vec_operand_v = std::is_same<std::decay_t<T>, PolyVec>::value ||
+                                       std::is_base_of<PolyVecExpr<std::decay_t<T>>, std::decay_t<T>>::value;
+
+template<typename L, typename R,
+         std::enable_if_t<is_poly_vec_operand_v<L> && is_poly_vec_operand_v<R>, int> = 0>
+PolyVecAddExpr<poly_vec_expr_t<L>, poly_vec_expr_t<R>> operator+(const L& lhs, const R& rhs) {
+    return PolyVecAddExpr<poly_vec_expr_t<L>, poly_vec_expr_t<R>>(as_poly_vec_expr(lhs), as_poly_vec_expr(rhs));
+}
+
+template<typename L, typename R,
+         std::enable_if_t<is_poly_vec_operand_v<L> && is_poly_vec_operand_v<R>, int> = 0>
+PolyVecSubExpr<poly_vec_expr_t<L>, poly_vec_expr_t<R>> operator-(const L& lhs, const R& rhs) {
+    return PolyVecSubExpr<poly_vec_expr_t<L>, poly_vec_expr_t<R>>(as_poly_vec_expr(lhs), as_poly_vec_expr(rhs));
+}
+
+template<typename E, std::enable_if_t<is_poly_vec_operand_v<E>, int> = 0>
+PolyVecScaleExpr<poly_vec_expr_t<E>> operator*(uint32_t scalar, const E& operand) {
+    return PolyVecScaleExpr<poly_vec_expr_t<E>>(as_poly_vec_expr(operand), scalar);
+}
+
+// Evaluates a vector expression row by row into result, resizing as needed
+template<typename E>
+void assign(PolyVec& result, const PolyVecExpr<E>& expr) {
+    const E& e = expr.self();
+    if (result.size() != e.size()) {
+        // Rows may alias result, so build the new vector before replacing it
+        PolyVec fresh;
+        fresh.reserve(e.size());
+        for (size_t j = 0; j < e.size(); ++j) {
+            fresh.emplace_back(e[j]);
+        }
+        result = std::move(fresh);
+        return;
+    }
+    for (size_t j = 0; j < e.size(); ++j) {
+        result[j] = e[j];
+    }
+}
+
+} // namespace clwe
+
+#endif // POLY_EXPR_HPP
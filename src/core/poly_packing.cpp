@@ -0,0 +1,158 @@
+#include "poly_packing.hpp"
+#include "poly_expr.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace clwe {
+
+namespace {
+
+void check_bits(uint32_t bits) {
+    if (bits == 0 || bits > 24) {
+        throw std::invalid_argument("Packed field width must be between 1 and 24 bits");
+    }
+}
+
+// Writes the 8 fields of one block (each < 2^bits) as `bits` bytes
+inline void pack_block(__m256i v, uint32_t bits, uint8_t* out) {
+    uint64_t pairs[4];
+#ifdef HAVE_AVX2
+    // 64-bit lanes: even field | odd field << bits
+    __m256i even = _mm256_and_si256(v, _mm256_set1_epi64x(0xFFFFFFFF));
+    __m256i odd = _mm256_srli_epi64(v, 32);
+    __m256i merged = _mm256_or_si256(even, _mm256_sll_epi64(odd, _mm_cvtsi32_si128(static_cast<int>(bits))));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pairs), merged);
+#else
+    for (int j = 0; j < 4; ++j) {
+        pairs[j] = static_cast<uint64_t>(v.m[2 * j]) | (static_cast<uint64_t>(v.m[2 * j + 1]) << bits);
+    }
+#endif
+    uint64_t acc = 0;
+    uint32_t acc_bits = 0;
+    for (int j = 0; j < 4; ++j) {
+        acc |= pairs[j] << acc_bits;
+        acc_bits += 2 * bits;
+        while (acc_bits >= 8) {
+            *out++ = static_cast<uint8_t>(acc);
+            acc >>= 8;
+            acc_bits -= 8;
+        }
+    }
+}
+
+// Reads the 8 fields of one block; `in` must have 3 readable bytes past the block
+inline __m256i unpack_block(const uint8_t* in, uint32_t bits) {
+#ifdef HAVE_AVX2
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i bit_pos = _mm256_mullo_epi32(lane, _mm256_set1_epi32(static_cast<int>(bits)));
+    const __m256i offsets = _mm256_srli_epi32(bit_pos, 3);
+    const __m256i shifts = _mm256_and_si256(bit_pos, _mm256_set1_epi32(7));
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>((1u << bits) - 1));
+
+    __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(in), offsets, 1);
+    return _mm256_and_si256(_mm256_srlv_epi32(words, shifts), mask);
+#else
+    __m256i r;
+    for (uint32_t j = 0; j < 8; ++j) {
+        uint32_t pos = j * bits;
+        uint32_t word;
+        std::memcpy(&word, in + pos / 8, 4);
+        r.m[j] = (word >> (pos % 8)) & ((1u << bits) - 1);
+    }
+    return r;
+#endif
+}
+
+template<typename Transform>
+void pack_blocks(const AVXPolynomial& poly, uint32_t bits, uint8_t* out, Transform transform) {
+    check_bits(bits);
+    const __m256i* coeffs = poly.avx_coeffs();
+    const __m256i limit = poly_expr_detail::lane_set1(bits == 32 ? 0 : (1u << bits));
+    for (uint32_t i = 0; i < poly.degree() / 8; ++i) {
+        __m256i v = transform(coeffs[i]);
+#ifdef HAVE_AVX2
+        // Any lane >= 2^bits: max(v, limit) == v
+        __m256i over = _mm256_cmpeq_epi32(_mm256_max_epu32(v, limit), v);
+        if (!_mm256_testz_si256(over, over)) {
+            throw std::invalid_argument("Coefficient does not fit in packed field");
+        }
+#else
+        for (int j = 0; j < 8; ++j) {
+            if (v.m[j] >= limit.m[j]) {
+                throw std::invalid_argument("Coefficient does not fit in packed field");
+            }
+        }
+#endif
+        pack_block(v, bits, out + static_cast<size_t>(i) * bits);
+    }
+}
+
+template<typename Transform>
+void unpack_blocks(const uint8_t* in, uint32_t bits, AVXPolynomial& poly, Transform transform) {
+    check_bits(bits);
+    __m256i* coeffs = poly.avx_coeffs();
+    const uint32_t blocks = poly.degree() / 8;
+    for (uint32_t i = 0; i < blocks; ++i) {
+        const uint8_t* src = in + static_cast<size_t>(i) * bits;
+        if (i + 1 == blocks) {
+            // The gather reads up to 3 bytes past the last field
+            uint8_t padded[32] = {0};
+            std::memcpy(padded, src, bits);
+            coeffs[i] = transform(unpack_block(padded, bits));
+        } else {
+            coeffs[i] = transform(unpack_block(src, bits));
+        }
+    }
+}
+
+} // namespace
+
+size_t packed_poly_bytes(uint32_t degree, uint32_t bits) {
+    return static_cast<size_t>(degree) * bits / 8;
+}
+
+void pack_poly(const AVXPolynomial& poly, uint32_t bits, uint8_t* out) {
+    pack_blocks(poly, bits, out, [](__m256i v) { return v; });
+}
+
+void unpack_poly(const uint8_t* in, uint32_t bits, AVXPolynomial& poly) {
+    const uint32_t q = poly.modulus();
+    unpack_blocks(in, bits, poly, [q](__m256i v) {
+#ifdef HAVE_AVX2
+        const __m256i q_minus_1 = _mm256_set1_epi32(static_cast<int>(q - 1));
+        __m256i ok = _mm256_cmpeq_epi32(_mm256_max_epu32(v, q_minus_1), q_minus_1);
+        if (_mm256_movemask_epi8(ok) != -1) {
+            throw std::invalid_argument("Packed coefficient out of range");
+        }
+#else
+        for (int j = 0; j < 8; ++j) {
+            if (v.m[j] >= q) {
+                throw std::invalid_argument("Packed coefficient out of range");
+            }
+        }
+#endif
+        return v;
+    });
+}
+
+void pack_poly_offset(const AVXPolynomial& poly, uint32_t offset, uint32_t bits, uint8_t* out) {
+    using namespace poly_expr_detail;
+    const __m256i q = lane_set1(poly.modulus());
+    const __m256i base = lane_set1(offset % poly.modulus() + poly.modulus());
+    // offset - c mod q, from (offset mod q) + q - c in (0, 2q)
+    pack_blocks(poly, bits, out, [&](__m256i v) { return lane_csub(lane_sub(base, v), q); });
+}
+
+void unpack_poly_offset(const uint8_t* in, uint32_t offset, uint32_t bits, AVXPolynomial& poly) {
+    using namespace poly_expr_detail;
+    const uint32_t modulus = poly.modulus();
+    const __m256i q = lane_set1(modulus);
+    const __m256i m = lane_set1(barrett_constant(modulus));
+    const __m256i base = lane_set1(offset % modulus + modulus);
+    // offset - t with t < 2^bits; reduce in case 2^bits exceeds q
+    unpack_blocks(in, bits, poly, [&](__m256i t) {
+        return lane_reduce(lane_add(lane_sub(base, lane_reduce(t, q, m)), q), q, m);
+    });
+}
+
+} // namespace clwe
@@ -0,0 +1,30 @@
+#ifndef POLY_PACKING_HPP
+#define POLY_PACKING_HPP
+
+#include "polynomial.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace clwe {
+
+// Little-endian bit packing of polynomial coefficients into fixed-width
+// fields of 1 to 24 bits. Eight coefficients occupy exactly `bits` bytes, so
+// the kernels work one AVX block at a time: packing merges lane pairs with
+// 64-bit variable shifts, unpacking gathers each field with a single 32-bit
+// load at its byte offset followed by a variable shift and mask.
+
+size_t packed_poly_bytes(uint32_t degree, uint32_t bits);
+
+// Throws std::invalid_argument if a coefficient does not fit in `bits`
+void pack_poly(const AVXPolynomial& poly, uint32_t bits, uint8_t* out);
+// Throws std::invalid_argument if a field decodes to a value >= modulus
+void unpack_poly(const uint8_t* in, uint32_t bits, AVXPolynomial& poly);
+
+// Coefficients c in (offset - 2^bits, offset], stored as offset - c. This is
+// the usual encoding of signature vectors with coefficients in (-gamma, gamma].
+void pack_poly_offset(const AVXPolynomial& poly, uint32_t offset, uint32_t bits, uint8_t* out);
+void unpack_poly_offset(const uint8_t* in, uint32_t offset, uint32_t bits, AVXPolynomial& poly);
+
+} // namespace clwe
+
+#endif // POLY_PACKING_HPP
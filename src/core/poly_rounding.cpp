@@ -0,0 +1,283 @@
+#include "poly_rounding.hpp"
+#include "poly_expr.hpp"
+#include <stdexcept>
+
+namespace clwe {
+
+namespace {
+
+void check_shape(const AVXPolynomial& a, const AVXPolynomial& b) {
+    poly_expr_detail::check_compatible(a.degree(), a.modulus(), b.degree(), b.modulus());
+}
+
+void resize_like(std::vector<AVXPolynomial>& out, const std::vector<AVXPolynomial>& in) {
+    out.clear();
+    out.reserve(in.size());
+    for (const auto& poly : in) {
+        out.emplace_back(poly.degree(), poly.modulus());
+    }
+}
+
+#ifdef HAVE_AVX2
+// floor(x / alpha) for x < 2^31 via the 64-bit product x * magic >> shift
+inline __m256i divide_avx(__m256i x, __m256i magic, int shift) {
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, magic), shift);
+    __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), magic), shift);
+    return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+}
+
+// Adds q to negative lanes
+inline __m256i to_field_avx(__m256i x, __m256i q) {
+    return _mm256_add_epi32(x, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), x), q));
+}
+#endif
+
+} // namespace
+
+PolyRounding::PolyRounding(uint32_t q, uint32_t gamma2, uint32_t d)
+    : q_(q), gamma2_(gamma2), d_(d), alpha_(2 * gamma2), m_(0), div_magic_(0), div_shift_(0) {
+    if (q % 2 == 0 || q >= (1u << 30)) {
+        throw std::invalid_argument("Rounding requires an odd modulus below 2^30");
+    }
+    if (gamma2 == 0 || (q - 1) % alpha_ != 0) {
+        throw std::invalid_argument("2 * gamma2 must divide q - 1");
+    }
+    if (d == 0 || d >= 31) {
+        throw std::invalid_argument("Power2Round bit count out of range");
+    }
+    m_ = (q - 1) / alpha_;
+
+    // Dividends stay below 2q < 2^n; with shift = n + ceil(log2(alpha)) the
+    // rounded-up reciprocal is exact and fits in 32 bits
+    uint32_t n = static_cast<uint32_t>(bit_length(q)) + 1;
+    uint32_t log_alpha = static_cast<uint32_t>(bit_length(alpha_ - 1));
+    div_shift_ = n + log_alpha;
+    div_magic_ = static_cast<uint32_t>(((uint64_t(1) << div_shift_) + alpha_ - 1) / alpha_);
+}
+
+void PolyRounding::decompose_block(__m256i r, __m256i& r1, __m256i& r0) const {
+#ifdef HAVE_AVX2
+    const __m256i alpha = _mm256_set1_epi32(alpha_);
+    const __m256i m = _mm256_set1_epi32(m_);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    // r1 = floor((r + gamma2 - 1) / alpha), r0 = r - r1 * alpha
+    __m256i x = _mm256_add_epi32(r, _mm256_set1_epi32(gamma2_ - 1));
+    r1 = divide_avx(x, _mm256_set1_epi32(div_magic_), static_cast<int>(div_shift_));
+    r0 = _mm256_sub_epi32(r, _mm256_mullo_epi32(r1, alpha));
+
+    // Top class: r1 = m folds to 0 with r0 - 1
+    __m256i wrap = _mm256_cmpeq_epi32(r1, m);
+    r1 = _mm256_andnot_si256(wrap, r1);
+    r0 = _mm256_sub_epi32(r0, _mm256_and_si256(wrap, one));
+#else
+    for (int j = 0; j < 8; ++j) {
+        uint32_t x = r.m[j] + gamma2_ - 1;
+        uint32_t hi = static_cast<uint32_t>((static_cast<uint64_t>(x) * div_magic_) >> div_shift_);
+        int32_t lo = static_cast<int32_t>(r.m[j] - hi * alpha_);
+        if (hi == m_) {
+            hi = 0;
+            lo -= 1;
+        }
+        r1.m[j] = hi;
+        r0.m[j] = static_cast<uint32_t>(lo);
+    }
+#endif
+}
+
+void PolyRounding::power2round(const AVXPolynomial& t, AVXPolynomial& t1, AVXPolynomial& t0) const {
+    check_shape(t, t1);
+    check_shape(t, t0);
+    const __m256i* in = t.avx_coeffs();
+    __m256i* hi = t1.avx_coeffs();
+    __m256i* lo = t0.avx_coeffs();
+
+#ifdef HAVE_AVX2
+    const __m256i q = _mm256_set1_epi32(q_);
+    const __m256i bias = _mm256_set1_epi32((1u << (d_ - 1)) - 1);
+    for (uint32_t i = 0; i < t.degree() / 8; ++i) {
+        // t1 = (t + 2^(d-1) - 1) >> d, t0 = t - t1 * 2^d
+        __m256i r1 = _mm256_srli_epi32(_mm256_add_epi32(in[i], bias), d_);
+        __m256i r0 = _mm256_sub_epi32(in[i], _mm256_slli_epi32(r1, d_));
+        hi[i] = r1;
+        lo[i] = to_field_avx(r0, q);
+    }
+#else
+    for (uint32_t i = 0; i < t.degree() / 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            uint32_t r1 = (in[i].m[j] + (1u << (d_ - 1)) - 1) >> d_;
+            int32_t r0 = static_cast<int32_t>(in[i].m[j] - (r1 << d_));
+            hi[i].m[j] = r1;
+            lo[i].m[j] = r0 < 0 ? static_cast<uint32_t>(r0 + static_cast<int32_t>(q_)) : static_cast<uint32_t>(r0);
+        }
+    }
+#endif
+}
+
+void PolyRounding::decompose(const AVXPolynomial& r, AVXPolynomial& r1, AVXPolynomial& r0) const {
+    check_shape(r, r1);
+    check_shape(r, r0);
+    const __m256i* in = r.avx_coeffs();
+    __m256i* hi = r1.avx_coeffs();
+    __m256i* lo = r0.avx_coeffs();
+
+    for (uint32_t i = 0; i < r.degree() / 8; ++i) {
+        __m256i h, l;
+        decompose_block(in[i], h, l);
+        hi[i] = h;
+#ifdef HAVE_AVX2
+        lo[i] = to_field_avx(l, _mm256_set1_epi32(q_));
+#else
+        for (int j = 0; j < 8; ++j) {
+            int32_t v = static_cast<int32_t>(l.m[j]);
+            lo[i].m[j] = v < 0 ? static_cast<uint32_t>(v + static_cast<int32_t>(q_)) : static_cast<uint32_t>(v);
+        }
+#endif
+    }
+}
+
+void PolyRounding::high_bits(const AVXPolynomial& r, AVXPolynomial& r1) const {
+    check_shape(r, r1);
+    const __m256i* in = r.avx_coeffs();
+    __m256i* hi = r1.avx_coeffs();
+    for (uint32_t i = 0; i < r.degree() / 8; ++i) {
+        __m256i l;
+        decompose_block(in[i], hi[i], l);
+    }
+}
+
+void PolyRounding::low_bits(const AVXPolynomial& r, AVXPolynomial& r0) const {
+    AVXPolynomial r1(r.degree(), r.modulus());
+    decompose(r, r1, r0);
+}
+
+uint32_t PolyRounding::make_hint(const AVXPolynomial& z, const AVXPolynomial& r, AVXPolynomial& h) const {
+    check_shape(z, r);
+    check_shape(r, h);
+    const __m256i* zc = z.avx_coeffs();
+    const __m256i* rc = r.avx_coeffs();
+    __m256i* out = h.avx_coeffs();
+    uint32_t count = 0;
+
+#ifdef HAVE_AVX2
+    const __m256i q = _mm256_set1_epi32(q_);
+    const __m256i one = _mm256_set1_epi32(1);
+    for (uint32_t i = 0; i < r.degree() / 8; ++i) {
+        __m256i sum = poly_expr_detail::lane_csub(_mm256_add_epi32(rc[i], zc[i]), q);
+        __m256i a1, a0, b1, b0;
+        decompose_block(rc[i], a1, a0);
+        decompose_block(sum, b1, b0);
+        __m256i differ = _mm256_andnot_si256(_mm256_cmpeq_epi32(a1, b1), one);
+        out[i] = differ;
+        count += static_cast<uint32_t>(__builtin_popcount(
+            _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(differ, 31)))));
+    }
+#else
+    for (uint32_t i = 0; i < r.degree() / 8; ++i) {
+        __m256i sum;
+        for (int j = 0; j < 8; ++j) {
+            uint32_t s = rc[i].m[j] + zc[i].m[j];
+            sum.m[j] = s >= q_ ? s - q_ : s;
+        }
+        __m256i a1, a0, b1, b0;
+        decompose_block(rc[i], a1, a0);
+        decompose_block(sum, b1, b0);
+        for (int j = 0; j < 8; ++j) {
+            out[i].m[j] = a1.m[j] != b1.m[j] ? 1 : 0;
+            count += out[i].m[j];
+        }
+    }
+#endif
+    return count;
+}
+
+void PolyRounding::use_hint(const AVXPolynomial& h, const AVXPolynomial& r, AVXPolynomial& r1) const {
+    check_shape(h, r);
+    check_shape(r, r1);
+    const __m256i* hc = h.avx_coeffs();
+    const __m256i* rc = r.avx_coeffs();
+    __m256i* out = r1.avx_coeffs();
+
+#ifdef HAVE_AVX2
+    const __m256i m = _mm256_set1_epi32(m_);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i zero = _mm256_setzero_si256();
+    for (uint32_t i = 0; i < r.degree() / 8; ++i) {
+        __m256i hi, lo;
+        decompose_block(rc[i], hi, lo);
+        // Hinted lanes step to the neighbouring class in the direction of r0, mod m
+        __m256i up = poly_expr_detail::lane_csub(_mm256_add_epi32(hi, one), m);
+        __m256i down = poly_expr_detail::lane_csub(_mm256_add_epi32(hi, _mm256_sub_epi32(m, one)), m);
+        __m256i stepped = _mm256_blendv_epi8(down, up, _mm256_cmpgt_epi32(lo, zero));
+        __m256i hinted = _mm256_cmpgt_epi32(hc[i], zero);
+        out[i] = _mm256_blendv_epi8(hi, stepped, hinted);
+    }
+#else
+    for (uint32_t i = 0; i < r.degree() / 8; ++i) {
+        __m256i hi, lo;
+        decompose_block(rc[i], hi, lo);
+        for (int j = 0; j < 8; ++j) {
+            uint32_t v = hi.m[j];
+            if (hc[i].m[j]) {
+                v = static_cast<int32_t>(lo.m[j]) > 0 ? (v + 1) % m_ : (v + m_ - 1) % m_;
+            }
+            out[i].m[j] = v;
+        }
+    }
+#endif
+}
+
+void PolyRounding::power2round(const std::vector<AVXPolynomial>& t, std::vector<AVXPolynomial>& t1,
+                               std::vector<AVXPolynomial>& t0) const {
+    resize_like(t1, t);
+    resize_like(t0, t);
+    for (size_t i = 0; i < t.size(); ++i) {
+        power2round(t[i], t1[i], t0[i]);
+    }
+}
+
+std::vector<AVXPolynomial> PolyRounding::high_bits(const std::vector<AVXPolynomial>& r) const {
+    std::vector<AVXPolynomial> r1;
+    resize_like(r1, r);
+    for (size_t i = 0; i < r.size(); ++i) {
+        high_bits(r[i], r1[i]);
+    }
+    return r1;
+}
+
+std::vector<AVXPolynomial> PolyRounding::low_bits(const std::vector<AVXPolynomial>& r) const {
+    std::vector<AVXPolynomial> r0;
+    resize_like(r0, r);
+    for (size_t i = 0; i < r.size(); ++i) {
+        low_bits(r[i], r0[i]);
+    }
+    return r0;
+}
+
+uint32_t PolyRounding::make_hint(const std::vector<AVXPolynomial>& z, const std::vector<AVXPolynomial>& r,
+                                 std::vector<AVXPolynomial>& h) const {
+    if (z.size() != r.size()) {
+        throw std::invalid_argument("Hint operands have different lengths");
+    }
+    resize_like(h, r);
+    uint32_t count = 0;
+    for (size_t i = 0; i < r.size(); ++i) {
+        count += make_hint(z[i], r[i], h[i]);
+    }
+    return count;
+}
+
+std::vector<AVXPolynomial> PolyRounding::use_hint(const std::vector<AVXPolynomial>& h,
+                                                  const std::vector<AVXPolynomial>& r) const {
+    if (h.size() != r.size()) {
+        throw std::invalid_argument("Hint operands have different lengths");
+    }
+    std::vector<AVXPolynomial> r1;
+    resize_like(r1, r);
+    for (size_t i = 0; i < r.size(); ++i) {
+        use_hint(h[i], r[i], r1[i]);
+    }
+    return r1;
+}
+
+} // namespace clwe
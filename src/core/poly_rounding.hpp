@@ -0,0 +1,62 @@
+#ifndef POLY_ROUNDING_HPP
+#define POLY_ROUNDING_HPP
+
+#include "polynomial.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace clwe {
+
+// Dilithium-style rounding of coefficients in [0, q):
+//
+//   Power2Round  r = r1 * 2^d + r0,            r0 in (-2^(d-1), 2^(d-1)]
+//   Decompose    r = r1 * 2 * gamma2 + r0,     r0 in (-gamma2, gamma2],
+//                with the top class r - r0 = q - 1 folded to r1 = 0, r0 - 1
+//
+// plus MakeHint/UseHint built on Decompose. Signed low parts are returned
+// mod q. All kernels process 8 coefficients per step; the division by
+// 2 * gamma2 is an exact multiply-high by a precomputed reciprocal.
+class PolyRounding {
+private:
+    uint32_t q_;
+    uint32_t gamma2_;
+    uint32_t d_;
+    uint32_t alpha_;        // 2 * gamma2
+    uint32_t m_;            // (q - 1) / alpha, number of high-bits classes
+    uint32_t div_magic_;    // ceil(2^div_shift_ / alpha)
+    uint32_t div_shift_;
+
+    void decompose_block(__m256i r, __m256i& r1, __m256i& r0) const;
+
+public:
+    // Requires q odd and below 2^30, and alpha dividing q - 1
+    PolyRounding(uint32_t q, uint32_t gamma2, uint32_t d);
+
+    void power2round(const AVXPolynomial& t, AVXPolynomial& t1, AVXPolynomial& t0) const;
+    void decompose(const AVXPolynomial& r, AVXPolynomial& r1, AVXPolynomial& r0) const;
+    void high_bits(const AVXPolynomial& r, AVXPolynomial& r1) const;
+    void low_bits(const AVXPolynomial& r, AVXPolynomial& r0) const;
+
+    // h_i = 1 where HighBits(r + z) != HighBits(r); returns the number of ones
+    uint32_t make_hint(const AVXPolynomial& z, const AVXPolynomial& r, AVXPolynomial& h) const;
+    // Recovers HighBits(r + z) from r and the hint
+    void use_hint(const AVXPolynomial& h, const AVXPolynomial& r, AVXPolynomial& r1) const;
+
+    // Polynomial-vector forms
+    void power2round(const std::vector<AVXPolynomial>& t, std::vector<AVXPolynomial>& t1,
+                     std::vector<AVXPolynomial>& t0) const;
+    std::vector<AVXPolynomial> high_bits(const std::vector<AVXPolynomial>& r) const;
+    std::vector<AVXPolynomial> low_bits(const std::vector<AVXPolynomial>& r) const;
+    uint32_t make_hint(const std::vector<AVXPolynomial>& z, const std::vector<AVXPolynomial>& r,
+                       std::vector<AVXPolynomial>& h) const;
+    std::vector<AVXPolynomial> use_hint(const std::vector<AVXPolynomial>& h,
+                                        const std::vector<AVXPolynomial>& r) const;
+
+    uint32_t modulus() const { return q_; }
+    uint32_t gamma2() const { return gamma2_; }
+    uint32_t high_bits_classes() const { return m_; }
+};
+
+} // namespace clwe
+
+#endif // POLY_ROUNDING_HPP
@@ -1,23 +1,29 @@
 #include "polynomial.hpp"
+#include "poly_expr.hpp"
 #include <cstring>
 #include <algorithm>
+#include <stdexcept>
 
 namespace clwe {
 
-AVXPolynomial::AVXPolynomial(uint32_t degree, uint32_t modulus, AVXNTTEngine* ntt)
-    : degree_(degree), modulus_(modulus), coeffs_(nullptr), ntt_(ntt) {
+AVXPolynomial::AVXPolynomial(uint32_t degree, uint32_t modulus, AVXNTTEngine* ntt,
+                             std::pmr::memory_resource* resource)
+    : degree_(degree), modulus_(modulus), coeffs_(nullptr), ntt_(ntt),
+      resource_(resource ? resource : current_memory_resource()) {
     allocate_coeffs();
     set_zero();
 }
 
 AVXPolynomial::AVXPolynomial(const AVXPolynomial& other)
-    : degree_(other.degree_), modulus_(other.modulus_), coeffs_(nullptr), ntt_(other.ntt_) {
+    : degree_(other.degree_), modulus_(other.modulus_), coeffs_(nullptr), ntt_(other.ntt_),
+      resource_(current_memory_resource()) {
     allocate_coeffs();
     memcpy(coeffs_, other.coeffs_, (degree_ / 8) * sizeof(__m256i));
 }
 
 AVXPolynomial::AVXPolynomial(AVXPolynomial&& other) noexcept
-    : degree_(other.degree_), modulus_(other.modulus_), coeffs_(other.coeffs_), ntt_(other.ntt_) {
+    : degree_(other.degree_), modulus_(other.modulus_), coeffs_(other.coeffs_), ntt_(other.ntt_),
+      resource_(other.resource_) {
     other.coeffs_ = nullptr;
     other.degree_ = 0;
 }
@@ -47,6 +53,7 @@ AVXPolynomial& AVXPolynomial::operator=(AVXPolynomial&& other) noexcept {
         modulus_ = other.modulus_;
         coeffs_ = other.coeffs_;
         ntt_ = other.ntt_;
+        resource_ = other.resource_;
         other.coeffs_ = nullptr;
         other.degree_ = 0;
     }
@@ -55,82 +62,27 @@ AVXPolynomial& AVXPolynomial::operator=(AVXPolynomial&& other) noexcept {
 
 void AVXPolynomial::allocate_coeffs() {
     if (degree_ > 0) {
-        coeffs_ = static_cast<__m256i*>(AVXAllocator::allocate((degree_ / 8) * sizeof(__m256i)));
+        coeffs_ = static_cast<__m256i*>(resource_->allocate((degree_ / 8) * sizeof(__m256i), alignof(__m256i)));
     }
 }
 
 void AVXPolynomial::deallocate_coeffs() {
     if (coeffs_) {
-        AVXAllocator::deallocate(coeffs_);
+        resource_->deallocate(coeffs_, (degree_ / 8) * sizeof(__m256i), alignof(__m256i));
         coeffs_ = nullptr;
     }
 }
 
 void AVXPolynomial::add_avx(const AVXPolynomial& other) {
-#ifdef HAVE_AVX2
-    for (uint32_t i = 0; i < degree_ / 8; ++i) {
-        coeffs_[i] = _mm256_add_epi32(coeffs_[i], other.coeffs_[i]);
-    }
-    mod_reduce_avx();
-#else
-    // Fallback for non-AVX architectures
-    uint32_t* coeffs = new uint32_t[degree_];
-    uint32_t* other_coeffs = new uint32_t[degree_];
-    copy_to(coeffs);
-    other.copy_to(other_coeffs);
-
-    for (uint32_t i = 0; i < degree_; ++i) {
-        coeffs[i] = (coeffs[i] + other_coeffs[i]) % modulus_;
-    }
-
-    copy_from(coeffs);
-    delete[] coeffs;
-    delete[] other_coeffs;
-#endif
+    *this = *this + other;
 }
 
 void AVXPolynomial::sub_avx(const AVXPolynomial& other) {
-#ifdef HAVE_AVX2
-    for (uint32_t i = 0; i < degree_ / 8; ++i) {
-        coeffs_[i] = _mm256_sub_epi32(coeffs_[i], other.coeffs_[i]);
-    }
-    mod_reduce_avx();
-#else
-    // Fallback for non-AVX architectures
-    uint32_t* coeffs = new uint32_t[degree_];
-    uint32_t* other_coeffs = new uint32_t[degree_];
-    copy_to(coeffs);
-    other.copy_to(other_coeffs);
-
-    for (uint32_t i = 0; i < degree_; ++i) {
-        coeffs[i] = (coeffs[i] - other_coeffs[i] + modulus_) % modulus_;
-    }
-
-    copy_from(coeffs);
-    delete[] coeffs;
-    delete[] other_coeffs;
-#endif
+    *this = *this - other;
 }
 
 void AVXPolynomial::scalar_mul_avx(uint32_t scalar) {
-#ifdef HAVE_AVX2
-    __m256i scalar_vec = _mm256_set1_epi32(scalar);
-    for (uint32_t i = 0; i < degree_ / 8; ++i) {
-        coeffs_[i] = _mm256_mullo_epi32(coeffs_[i], scalar_vec);
-    }
-    mod_reduce_avx();
-#else
-    // Fallback for non-AVX architectures
-    uint32_t* coeffs = new uint32_t[degree_];
-    copy_to(coeffs);
-
-    for (uint32_t i = 0; i < degree_; ++i) {
-        coeffs[i] = (coeffs[i] * scalar) % modulus_;
-    }
-
-    copy_from(coeffs);
-    delete[] coeffs;
-#endif
+    *this = scalar * *this;
 }
 
 void AVXPolynomial::mod_reduce_avx() {
@@ -153,6 +105,18 @@ void AVXPolynomial::multiply_ntt_avx(const AVXPolynomial& other, AVXPolynomial&
 
 void AVXPolynomial::copy_from(const uint32_t* coeffs) {
 #ifdef HAVE_AVX2
+    if (degree_ % 8 == 0) {
+        if (reinterpret_cast<uintptr_t>(coeffs) % 32 == 0) {
+            for (uint32_t i = 0; i < degree_ / 8; ++i) {
+                coeffs_[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(coeffs) + i);
+            }
+        } else {
+            for (uint32_t i = 0; i < degree_ / 8; ++i) {
+                coeffs_[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(coeffs) + i);
+            }
+        }
+        return;
+    }
     for (uint32_t i = 0; i < degree_; i += 8) {
         uint32_t vals[8];
         for (int j = 0; j < 8; ++j) {
@@ -172,6 +136,18 @@ void AVXPolynomial::copy_from(const uint32_t* coeffs) {
 
 void AVXPolynomial::copy_to(uint32_t* coeffs) const {
 #ifdef HAVE_AVX2
+    if (degree_ % 8 == 0) {
+        if (reinterpret_cast<uintptr_t>(coeffs) % 32 == 0) {
+            for (uint32_t i = 0; i < degree_ / 8; ++i) {
+                _mm256_store_si256(reinterpret_cast<__m256i*>(coeffs) + i, coeffs_[i]);
+            }
+        } else {
+            for (uint32_t i = 0; i < degree_ / 8; ++i) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(coeffs) + i, coeffs_[i]);
+            }
+        }
+        return;
+    }
     for (uint32_t i = 0; i < degree_; i += 8) {
         uint32_t vals[8];
         _mm256_storeu_si256(reinterpret_cast<__m256i*>(vals), coeffs_[i/8]);
@@ -212,27 +188,49 @@ void AVXPolynomial::set_coeff(uint32_t index, uint32_t value) {
 }
 
 uint32_t AVXPolynomial::infinity_norm() const {
-    uint32_t max_norm = 0;
-    for (uint32_t i = 0; i < degree_; ++i) {
-        uint32_t coeff = 0;
 #ifdef HAVE_AVX2
-        // Extract coefficient (simplified - should be more efficient)
-        uint32_t avx_index = i / 8;
-        uint32_t sub_index = i % 8;
-        uint32_t vals[8];
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(vals), coeffs_[avx_index]);
-        coeff = vals[sub_index];
+    // Centered |coeff| = min(coeff, q - coeff), 8 lanes at a time
+    const __m256i q = _mm256_set1_epi32(modulus_);
+    __m256i max_vec = _mm256_setzero_si256();
+    for (uint32_t i = 0; i < degree_ / 8; ++i) {
+        __m256i c = coeffs_[i];
+        __m256i centered = _mm256_min_epu32(c, _mm256_sub_epi32(q, c));
+        max_vec = _mm256_max_epu32(max_vec, centered);
+    }
+    uint32_t vals[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(vals), max_vec);
+    return *std::max_element(vals, vals + 8);
 #else
-        uint32_t avx_index = i / 8;
-        uint32_t sub_index = i % 8;
-        coeff = coeffs_[avx_index].m[sub_index];
-#endif
-
-        // Compute |coeff - q/2| for centered norm
+    uint32_t max_norm = 0;
+    for (uint32_t i = 0; i < degree_; ++i) {
+        uint32_t coeff = coeffs_[i / 8].m[i % 8];
         uint32_t centered = (coeff > modulus_/2) ? modulus_ - coeff : coeff;
         max_norm = std::max(max_norm, centered);
     }
     return max_norm;
+#endif
+}
+
+bool AVXPolynomial::exceeds_norm(uint32_t bound) const {
+#ifdef HAVE_AVX2
+    const __m256i q = _mm256_set1_epi32(modulus_);
+    const __m256i limit = _mm256_set1_epi32(bound);
+    for (uint32_t i = 0; i < degree_ / 8; ++i) {
+        __m256i c = coeffs_[i];
+        __m256i centered = _mm256_min_epu32(c, _mm256_sub_epi32(q, c));
+        // centered >= bound  <=>  max(centered, bound) == centered
+        __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(centered, limit), centered);
+        if (!_mm256_testz_si256(ge, ge)) return true;
+    }
+    return false;
+#else
+    for (uint32_t i = 0; i < degree_; ++i) {
+        uint32_t coeff = coeffs_[i / 8].m[i % 8];
+        uint32_t centered = (coeff > modulus_/2) ? modulus_ - coeff : coeff;
+        if (centered >= bound) return true;
+    }
+    return false;
+#endif
 }
 
 } // namespace clwe
\ No newline at end of file
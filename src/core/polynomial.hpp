@@ -3,27 +3,40 @@
 
 #include "utils.hpp"
 #include "ntt_avx.hpp"
+#include "memory_resource.hpp"
 #include <cstdint>
 #include <vector>
 
 namespace clwe {
 
+template<typename E> class PolyExpr;
+
 class AVXPolynomial {
 private:
     uint32_t degree_;
     uint32_t modulus_;
     __m256i* coeffs_;      // AVX-aligned coefficient array
     AVXNTTEngine* ntt_;    // NTT engine for multiplication
+    std::pmr::memory_resource* resource_;  // Source of coeffs_
 
 public:
-    AVXPolynomial(uint32_t degree, uint32_t modulus, AVXNTTEngine* ntt = nullptr);
+    // A null resource means current_memory_resource(). Copies allocate from
+    // the current resource; moves keep the source's storage and resource.
+    AVXPolynomial(uint32_t degree, uint32_t modulus, AVXNTTEngine* ntt = nullptr,
+                  std::pmr::memory_resource* resource = nullptr);
     AVXPolynomial(const AVXPolynomial& other);
     AVXPolynomial(AVXPolynomial&& other) noexcept;
     ~AVXPolynomial();
 
+    // Fused evaluation of a lazy expression (see poly_expr.hpp)
+    template<typename E>
+    AVXPolynomial(const PolyExpr<E>& expr);
+
     // Assignment operators
     AVXPolynomial& operator=(const AVXPolynomial& other);
     AVXPolynomial& operator=(AVXPolynomial&& other) noexcept;
+    template<typename E>
+    AVXPolynomial& operator=(const PolyExpr<E>& expr);
 
     // AVX vectorized operations
     void add_avx(const AVXPolynomial& other);
@@ -35,14 +48,19 @@ public:
     void multiply_ntt_avx(const AVXPolynomial& other, AVXPolynomial& result) const;
 
     // Utility functions
+    // 32-byte aligned buffers (e.g. AlignedVector) take the aligned load/store path
     void copy_from(const uint32_t* coeffs);
     void copy_to(uint32_t* coeffs) const;
     void set_zero();
     void set_coeff(uint32_t index, uint32_t value);
 
     uint32_t infinity_norm() const;
+    // True if some centered |coeff| >= bound; stops at the first violating block
+    bool exceeds_norm(uint32_t bound) const;
     uint32_t degree() const { return degree_; }
     uint32_t modulus() const { return modulus_; }
+    AVXNTTEngine* ntt_engine() const { return ntt_; }
+    std::pmr::memory_resource* resource() const { return resource_; }
 
     // Access to AVX coefficients (for NTT operations)
     __m256i* avx_coeffs() { return coeffs_; }
@@ -0,0 +1,209 @@
+#include "pool_allocator.hpp"
+#include "utils.hpp"
+#include <atomic>
+#include <mutex>
+#include <new>
+
+namespace clwe {
+
+namespace {
+
+// The header sits in front of the payload and keeps it ALIGNMENT-aligned
+constexpr size_t HEADER_SIZE = PoolAllocator::ALIGNMENT;
+constexpr uint32_t NUM_CLASSES = 11;  // 64 B .. 64 KiB
+constexpr uint32_t LARGE_CLASS = NUM_CLASSES;
+// Blocks per class a thread keeps before spilling a batch to the shared pool
+constexpr uint32_t THREAD_CACHE_LIMIT = 64;
+constexpr uint32_t TRANSFER_BATCH = 32;
+
+static_assert(PoolAllocator::MIN_CLASS_SIZE << (NUM_CLASSES - 1) == PoolAllocator::MAX_CLASS_SIZE,
+              "Size classes must cover MIN_CLASS_SIZE .. MAX_CLASS_SIZE");
+
+struct BlockHeader {
+    size_t size;
+    uint32_t size_class;
+};
+static_assert(sizeof(BlockHeader) <= HEADER_SIZE, "Block header too large");
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+inline BlockHeader* header_of(const void* ptr) {
+    return reinterpret_cast<BlockHeader*>(const_cast<char*>(static_cast<const char*>(ptr)) - HEADER_SIZE);
+}
+
+inline uint32_t size_class(size_t size) {
+    if (size <= PoolAllocator::MIN_CLASS_SIZE) return 0;
+    if (size > PoolAllocator::MAX_CLASS_SIZE) return LARGE_CLASS;
+    return static_cast<uint32_t>(bit_length(static_cast<uint32_t>(size - 1))) - 6;
+}
+
+inline size_t class_size(uint32_t cls) {
+    return PoolAllocator::MIN_CLASS_SIZE << cls;
+}
+
+std::atomic<uint64_t> system_allocations{0};
+std::atomic<uint64_t> system_bytes{0};
+std::atomic<PoolAllocator::Observer*> observer{nullptr};
+
+inline void* observed(void* ptr) {
+    if (PoolAllocator::Observer* o = observer.load(std::memory_order_relaxed)) {
+        o->on_allocate(header_of(ptr)->size);
+    }
+    return ptr;
+}
+
+void* system_block(size_t size, uint32_t cls) {
+    char* raw = static_cast<char*>(::operator new(HEADER_SIZE + size, std::align_val_t(PoolAllocator::ALIGNMENT)));
+    system_allocations.fetch_add(1, std::memory_order_relaxed);
+    system_bytes.fetch_add(HEADER_SIZE + size, std::memory_order_relaxed);
+    void* ptr = raw + HEADER_SIZE;
+    *header_of(ptr) = {size, cls};
+    return ptr;
+}
+
+void system_free(void* ptr) {
+    ::operator delete(reinterpret_cast<char*>(header_of(ptr)), std::align_val_t(PoolAllocator::ALIGNMENT));
+}
+
+struct SharedPool {
+    std::mutex mutex;
+    FreeBlock* lists[NUM_CLASSES] = {};
+};
+
+// Leaked on purpose: threads may exit after static destructors have run
+SharedPool& shared_pool() {
+    static SharedPool* pool = new SharedPool;
+    return *pool;
+}
+
+// Trivially destructible, so it stays valid while other thread_local
+// destructors free memory during thread exit
+struct ThreadCache {
+    FreeBlock* lists[NUM_CLASSES];
+    uint32_t counts[NUM_CLASSES];
+    bool registered;
+    bool retired;
+};
+thread_local ThreadCache thread_cache;
+
+struct ThreadCacheReaper {
+    ~ThreadCacheReaper() {
+        SharedPool& pool = shared_pool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        for (uint32_t cls = 0; cls < NUM_CLASSES; ++cls) {
+            while (FreeBlock* block = thread_cache.lists[cls]) {
+                thread_cache.lists[cls] = block->next;
+                block->next = pool.lists[cls];
+                pool.lists[cls] = block;
+            }
+            thread_cache.counts[cls] = 0;
+        }
+        thread_cache.retired = true;
+    }
+};
+thread_local ThreadCacheReaper thread_cache_reaper;
+
+ThreadCache& local_cache() {
+    ThreadCache& cache = thread_cache;
+    if (!cache.registered) {
+        // First use on this thread: touching the reaper registers its destructor
+        cache.registered = true;
+        (void)&thread_cache_reaper;
+    }
+    return cache;
+}
+
+void refill(ThreadCache& cache, uint32_t cls) {
+    SharedPool& pool = shared_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (uint32_t i = 0; i < TRANSFER_BATCH && pool.lists[cls]; ++i) {
+        FreeBlock* block = pool.lists[cls];
+        pool.lists[cls] = block->next;
+        block->next = cache.lists[cls];
+        cache.lists[cls] = block;
+        ++cache.counts[cls];
+    }
+}
+
+void spill(ThreadCache& cache, uint32_t cls) {
+    SharedPool& pool = shared_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (uint32_t i = 0; i < TRANSFER_BATCH && cache.lists[cls]; ++i) {
+        FreeBlock* block = cache.lists[cls];
+        cache.lists[cls] = block->next;
+        --cache.counts[cls];
+        block->next = pool.lists[cls];
+        pool.lists[cls] = block;
+    }
+}
+
+} // namespace
+
+void* PoolAllocator::allocate(size_t size) {
+    const uint32_t cls = size_class(size);
+    if (cls == LARGE_CLASS) {
+        return observed(system_block(size, LARGE_CLASS));
+    }
+
+    ThreadCache& cache = local_cache();
+    if (cache.retired) {
+        SharedPool& pool = shared_pool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (FreeBlock* block = pool.lists[cls]) {
+            pool.lists[cls] = block->next;
+            return observed(block);
+        }
+    } else if (!cache.lists[cls]) {
+        refill(cache, cls);
+    }
+    if (FreeBlock* block = cache.lists[cls]) {
+        cache.lists[cls] = block->next;
+        --cache.counts[cls];
+        return observed(block);
+    }
+    return observed(system_block(class_size(cls), cls));
+}
+
+void PoolAllocator::deallocate(void* ptr) {
+    if (!ptr) return;
+    if (Observer* o = observer.load(std::memory_order_relaxed)) {
+        o->on_deallocate(header_of(ptr)->size);
+    }
+    const uint32_t cls = header_of(ptr)->size_class;
+    if (cls == LARGE_CLASS) {
+        system_free(ptr);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    ThreadCache& cache = local_cache();
+    if (cache.retired) {
+        // Freed during thread exit, after the cache was handed back
+        SharedPool& pool = shared_pool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        block->next = pool.lists[cls];
+        pool.lists[cls] = block;
+        return;
+    }
+    block->next = cache.lists[cls];
+    cache.lists[cls] = block;
+    if (++cache.counts[cls] > THREAD_CACHE_LIMIT) {
+        spill(cache, cls);
+    }
+}
+
+size_t PoolAllocator::block_size(const void* ptr) {
+    return ptr ? header_of(ptr)->size : 0;
+}
+
+PoolAllocator::Stats PoolAllocator::stats() {
+    return {system_allocations.load(std::memory_order_relaxed), system_bytes.load(std::memory_order_relaxed)};
+}
+
+void PoolAllocator::set_observer(Observer* o) {
+    observer.store(o, std::memory_order_relaxed);
+}
+
+} // namespace clwe
@@ -0,0 +1,48 @@
+#ifndef POOL_ALLOCATOR_HPP
+#define POOL_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace clwe {
+
+// Size-class pool behind AVXAllocator. Requests up to MAX_CLASS_SIZE are
+// rounded up to a power-of-two class and served from a per-thread free list
+// without locking. A thread refills from and spills to a shared pool in
+// batches, and hands its whole cache to the shared pool when it exits.
+// Pooled memory is never returned to the system; larger requests bypass the
+// pool entirely.
+class PoolAllocator {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t MIN_CLASS_SIZE = 64;
+    static constexpr size_t MAX_CLASS_SIZE = 64 * 1024;
+
+    // Sees every pool allocation and deallocation while installed, on the
+    // calling thread; sizes are block_size(). Callbacks must not allocate
+    // from the pool. Meant for benchmarks and tests.
+    class Observer {
+    public:
+        virtual ~Observer() = default;
+        virtual void on_allocate(size_t bytes) = 0;
+        virtual void on_deallocate(size_t bytes) = 0;
+    };
+
+    struct Stats {
+        uint64_t system_allocations;  // blocks obtained from the system
+        uint64_t system_bytes;        // including block headers
+    };
+
+    // Never returns nullptr; throws std::bad_alloc
+    static void* allocate(size_t size);
+    static void deallocate(void* ptr);
+    // Usable size of a block returned by allocate
+    static size_t block_size(const void* ptr);
+    static Stats stats();
+    // nullptr removes the observer; the caller keeps ownership
+    static void set_observer(Observer* observer);
+};
+
+} // namespace clwe
+
+#endif // POOL_ALLOCATOR_HPP
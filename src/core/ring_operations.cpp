@@ -1,11 +1,15 @@
 #include "clwe/ring_operations.hpp"
 #include "polynomial.hpp"
+#include "poly_expr.hpp"
+#include "memory_resource.hpp"
 #include "ntt_avx.hpp"
 #include "utils.hpp"
+#include "clwe/instrumentation.hpp"
 #include <cstring>
 #include <algorithm>
 #include <random>
 #include <array>
+#include <stdexcept>
 
 namespace clwe {
 
@@ -30,7 +34,10 @@ uint32_t simple_hash(const uint8_t* data, size_t len, uint32_t counter) {
 }
 
 // Deterministic matrix A generation from seed
-std::vector<std::vector<AVXPolynomial>> RingOperations::generate_matrix_A(const std::array<uint8_t, 32>& seed) const {
+std::vector<std::vector<AVXPolynomial>> RingOperations::generate_matrix_A(const std::array<uint8_t, 32>& seed,
+                                                                           std::pmr::memory_resource* resource) const {
+    CLWE_INSTRUMENT(MatrixExpansion);
+    ScopedMemoryResource scope(resource);
     uint32_t k = params_.module_rank;
     uint32_t d = params_.degree;
     uint32_t q = params_.modulus;
@@ -40,7 +47,7 @@ std::vector<std::vector<AVXPolynomial>> RingOperations::generate_matrix_A(const
 
     for (uint32_t i = 0; i < k; ++i) {
         for (uint32_t j = 0; j < k; ++j) {
-            std::vector<uint32_t> coeffs(d);
+            AlignedVector<uint32_t> coeffs(d);
             for (uint32_t c = 0; c < d; ++c) {
                 // Use seed + position as input to hash
                 uint32_t counter = (i * k * d) + (j * d) + c;
@@ -54,10 +61,13 @@ std::vector<std::vector<AVXPolynomial>> RingOperations::generate_matrix_A(const
 }
 
 // Binomial sampling implementation
-AVXPolynomial RingOperations::sample_binomial(uint32_t eta, const std::array<uint8_t, 32>& randomness) const {
+AVXPolynomial RingOperations::sample_binomial(uint32_t eta, const std::array<uint8_t, 32>& randomness,
+                                              std::pmr::memory_resource* resource) const {
+    CLWE_INSTRUMENT(Sampling);
+    ScopedMemoryResource scope(resource);
     AVXPolynomial result(params_.degree, params_.modulus, ntt_engine_);
 
-    std::vector<uint32_t> coeffs(params_.degree);
+    AlignedVector<uint32_t> coeffs(params_.degree);
 
     for (uint32_t i = 0; i < params_.degree; ++i) {
         int32_t a = 0, b = 0;
@@ -82,38 +92,14 @@ AVXPolynomial RingOperations::sample_binomial(uint32_t eta, const std::array<uin
 }
 
 std::vector<AVXPolynomial> RingOperations::sample_binomial_batch(uint32_t eta, uint32_t count,
-                                                                 const std::array<uint8_t, 32>& seed) const {
+                                                                 const std::array<uint8_t, 32>& seed,
+                                                                 std::pmr::memory_resource* resource) const {
+    CLWE_INSTRUMENT(Sampling);
+    ScopedMemoryResource scope(resource);
     std::vector<AVXPolynomial> result;
     result.reserve(count);
 
-    // Use AVX-512 accelerated batch sampling if available
-#ifdef HAVE_AVX512
-    if (count >= 4) {  // Only use batch sampling for larger batches
-        // Prepare batch of coefficient arrays
-        std::vector<uint32_t*> coeffs_batch(count);
-        std::vector<std::vector<uint32_t>> coeffs_data(count, std::vector<uint32_t>(params_.degree));
-
-        for (uint32_t i = 0; i < count; ++i) {
-            coeffs_batch[i] = coeffs_data[i].data();
-        }
-
-        // Create sampler and sample batch
-        SHAKE256Sampler sampler;
-        sampler.init(seed.data(), seed.size());
-        sampler.sample_polynomial_binomial_batch_avx512(coeffs_batch.data(), count,
-                                                       params_.degree, eta, params_.modulus);
-
-        // Convert to polynomials
-        for (uint32_t i = 0; i < count; ++i) {
-            AVXPolynomial poly(params_.degree, params_.modulus, ntt_engine_);
-            poly.copy_from(coeffs_data[i].data());
-            result.push_back(std::move(poly));
-        }
-        return result;
-    }
-#endif
-
-    // Fallback to individual sampling
+    // Each polynomial comes from its own derived seed, so results do not depend on the ISA
     for (uint32_t i = 0; i < count; ++i) {
         std::array<uint8_t, 32> derived_seed;
         std::copy(seed.begin(), seed.end(), derived_seed.begin());
@@ -130,18 +116,15 @@ std::vector<AVXPolynomial> RingOperations::sample_binomial_batch(uint32_t eta, u
 
 // AVX-optimized polynomial operations
 void RingOperations::poly_add_avx(const AVXPolynomial& a, const AVXPolynomial& b, AVXPolynomial& result) const {
-    result.add_avx(a);
-    result.add_avx(b);
+    result = a + b;
 }
 
 void RingOperations::poly_sub_avx(const AVXPolynomial& a, const AVXPolynomial& b, AVXPolynomial& result) const {
-    result = a;
-    result.sub_avx(b);
+    result = a - b;
 }
 
 void RingOperations::poly_scalar_mul_avx(const AVXPolynomial& a, uint32_t scalar, AVXPolynomial& result) const {
-    result = a;
-    result.scalar_mul_avx(scalar);
+    result = scalar * a;
 }
 
 // AVX-optimized matrix-vector multiplication
@@ -162,7 +145,9 @@ void RingOperations::matrix_vector_mul_avx(const std::vector<std::vector<AVXPoly
 }
 
 std::vector<AVXPolynomial> RingOperations::matrix_vector_mul(const std::vector<std::vector<AVXPolynomial>>& A,
-                                                           const std::vector<AVXPolynomial>& v) const {
+                                                           const std::vector<AVXPolynomial>& v,
+                                                           std::pmr::memory_resource* resource) const {
+    ScopedMemoryResource scope(resource);
     uint32_t k = params_.module_rank;
     std::vector<AVXPolynomial> result(k, AVXPolynomial(params_.degree, params_.modulus, ntt_engine_));
     matrix_vector_mul_avx(A, v, result);
@@ -187,7 +172,9 @@ void RingOperations::matrix_transpose_vector_mul_avx(const std::vector<std::vect
 }
 
 std::vector<AVXPolynomial> RingOperations::matrix_transpose_vector_mul(const std::vector<std::vector<AVXPolynomial>>& A,
-                                                                     const std::vector<AVXPolynomial>& v) const {
+                                                                     const std::vector<AVXPolynomial>& v,
+                                                                     std::pmr::memory_resource* resource) const {
+    ScopedMemoryResource scope(resource);
     uint32_t k = params_.module_rank;
     std::vector<AVXPolynomial> result(k, AVXPolynomial(params_.degree, params_.modulus, ntt_engine_));
     matrix_transpose_vector_mul_avx(A, v, result);
@@ -210,16 +197,20 @@ void RingOperations::inner_product_avx(const std::vector<AVXPolynomial>& a,
 }
 
 AVXPolynomial RingOperations::inner_product(const std::vector<AVXPolynomial>& a,
-                                          const std::vector<AVXPolynomial>& b) const {
+                                          const std::vector<AVXPolynomial>& b,
+                                          std::pmr::memory_resource* resource) const {
+    ScopedMemoryResource scope(resource);
     AVXPolynomial result(params_.degree, params_.modulus, ntt_engine_);
     inner_product_avx(a, b, result);
     return result;
 }
 
 // Message encoding/decoding
-AVXPolynomial RingOperations::encode_message_to_poly(const std::vector<uint8_t>& message) const {
+AVXPolynomial RingOperations::encode_message_to_poly(const std::vector<uint8_t>& message,
+                                                     std::pmr::memory_resource* resource) const {
+    ScopedMemoryResource scope(resource);
     AVXPolynomial result(params_.degree, params_.modulus, ntt_engine_);
-    std::vector<uint32_t> coeffs(params_.degree, 0);
+    AlignedVector<uint32_t> coeffs(params_.degree, 0);
 
     size_t msg_len = std::min(message.size(), static_cast<size_t>(params_.degree));
     for (size_t i = 0; i < msg_len; ++i) {
@@ -231,7 +222,7 @@ AVXPolynomial RingOperations::encode_message_to_poly(const std::vector<uint8_t>&
 }
 
 std::vector<uint8_t> RingOperations::decode_poly_to_message(const AVXPolynomial& poly) const {
-    std::vector<uint32_t> coeffs(params_.degree);
+    AlignedVector<uint32_t> coeffs(params_.degree);
     poly.copy_to(coeffs.data());
 
     std::vector<uint8_t> message;
@@ -246,7 +237,8 @@ std::vector<uint8_t> RingOperations::decode_poly_to_message(const AVXPolynomial&
 
 // Serialization
 std::vector<uint8_t> RingOperations::serialize_polynomial(const AVXPolynomial& poly) const {
-    std::vector<uint32_t> coeffs(params_.degree);
+    CLWE_INSTRUMENT(Serialization);
+    AlignedVector<uint32_t> coeffs(params_.degree);
     poly.copy_to(coeffs.data());
 
     std::vector<uint8_t> data;
@@ -261,9 +253,12 @@ std::vector<uint8_t> RingOperations::serialize_polynomial(const AVXPolynomial& p
     return data;
 }
 
-AVXPolynomial RingOperations::deserialize_polynomial(const std::vector<uint8_t>& data) const {
+AVXPolynomial RingOperations::deserialize_polynomial(const std::vector<uint8_t>& data,
+                                                     std::pmr::memory_resource* resource) const {
+    CLWE_INSTRUMENT(Deserialization);
+    ScopedMemoryResource scope(resource);
     AVXPolynomial result(params_.degree, params_.modulus, ntt_engine_);
-    std::vector<uint32_t> coeffs(params_.degree, 0);
+    AlignedVector<uint32_t> coeffs(params_.degree, 0);
 
     size_t max_coeffs = std::min(data.size() / 4, static_cast<size_t>(params_.degree));
     for (size_t i = 0; i < max_coeffs; ++i) {
@@ -0,0 +1,1435 @@
+#include "clwe/sign.hpp"
+#include "poly_expr.hpp"
+#include "poly_packing.hpp"
+#include "utils.hpp"
+#include "cpu_features.hpp"
+#include "autotune.hpp"
+#include "clwe/instrumentation.hpp"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <random>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace clwe {
+
+namespace {
+
+// Bound on signing attempts; the expected count is below 5 at every level
+constexpr uint32_t MAX_SIGN_ATTEMPTS = 1000;
+
+// File hashing: mmap window (a multiple of the page size) and read chunk size
+constexpr size_t FILE_HASH_WINDOW = size_t(64) << 20;
+constexpr size_t FILE_HASH_CHUNK = size_t(1) << 20;
+
+// Largest challenge weight for which rotate-and-add beats a pointwise NTT
+// product plus inverse transform (about 60 at n = 256)
+constexpr uint32_t SPARSE_CHALLENGE_MAX_WEIGHT = 64;
+
+// Bounds on the number of signatures verified together against one A row
+// block in verify_batch; the block itself is sized to the L2 cache
+constexpr size_t VERIFY_BATCH_MIN_BLOCK = 4;
+constexpr size_t VERIFY_BATCH_MAX_BLOCK = 32;
+
+// One-shot SHAKE128/SHAKE256 over the concatenation of the absorbed buffers.
+// reset() reuses the context, which batch hashing relies on.
+class XOF {
+private:
+    const EVP_MD* md_;
+    EVP_MD_CTX* ctx_;
+
+public:
+    explicit XOF(const EVP_MD* md) : md_(md), ctx_(EVP_MD_CTX_new()) {
+        if (!ctx_ || EVP_DigestInit_ex(ctx_, md_, nullptr) != 1) {
+            EVP_MD_CTX_free(ctx_);
+            throw std::runtime_error("SHAKE initialization failed");
+        }
+    }
+    ~XOF() { EVP_MD_CTX_free(ctx_); }
+
+    XOF(const XOF&) = delete;
+    XOF& operator=(const XOF&) = delete;
+
+    void reset() {
+        if (EVP_DigestInit_ex(ctx_, md_, nullptr) != 1) {
+            throw std::runtime_error("SHAKE initialization failed");
+        }
+    }
+
+    void absorb(const uint8_t* data, size_t len) {
+        if (len > 0 && EVP_DigestUpdate(ctx_, data, len) != 1) {
+            throw std::runtime_error("SHAKE absorb failed");
+        }
+    }
+
+    void squeeze(uint8_t* out, size_t len) {
+        if (EVP_DigestFinalXOF(ctx_, out, len) != 1) {
+            throw std::runtime_error("SHAKE squeeze failed");
+        }
+    }
+};
+
+// XOF output of `len` bytes; longer requests extend shorter ones, so rejection
+// samplers that run dry can simply ask again for more
+std::vector<uint8_t> xof_expand(const EVP_MD* md, const std::vector<uint8_t>& input, size_t len) {
+    std::vector<uint8_t> out(len);
+    XOF xof(md);
+    xof.absorb(input.data(), input.size());
+    xof.squeeze(out.data(), len);
+    return out;
+}
+
+template<size_t N>
+std::vector<uint8_t> seed_with_nonce(const std::array<uint8_t, N>& seed, uint16_t nonce) {
+    std::vector<uint8_t> input(seed.begin(), seed.end());
+    input.push_back(static_cast<uint8_t>(nonce & 0xFF));
+    input.push_back(static_cast<uint8_t>(nonce >> 8));
+    return input;
+}
+
+// Little-endian bit stream access
+uint32_t read_bits(const uint8_t* buf, size_t bit_pos, uint32_t bits) {
+    uint32_t value = 0;
+    for (uint32_t b = 0; b < bits; ++b) {
+        size_t pos = bit_pos + b;
+        value |= static_cast<uint32_t>((buf[pos >> 3] >> (pos & 7)) & 1) << b;
+    }
+    return value;
+}
+
+void pack_bits(const uint32_t* values, size_t count, uint32_t bits, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    out.resize(start + (count * bits + 7) / 8, 0);
+    size_t bit_pos = 0;
+    for (size_t i = 0; i < count; ++i) {
+        for (uint32_t b = 0; b < bits; ++b, ++bit_pos) {
+            out[start + (bit_pos >> 3)] |= static_cast<uint8_t>(((values[i] >> b) & 1) << (bit_pos & 7));
+        }
+    }
+}
+
+uint32_t to_field(int64_t x, uint32_t q) {
+    int64_t r = x % static_cast<int64_t>(q);
+    return static_cast<uint32_t>(r < 0 ? r + q : r);
+}
+
+void write_u32(std::vector<uint8_t>& out, uint32_t value) {
+    // Big-endian, as RingOperations::serialize_polynomial
+    out.push_back((value >> 24) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+uint32_t read_u32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+void write_polys(std::vector<uint8_t>& out, const std::vector<AVXPolynomial>& polys) {
+    for (const auto& poly : polys) {
+        AlignedVector<uint32_t> coeffs(poly.degree());
+        poly.copy_to(coeffs.data());
+        for (uint32_t c : coeffs) write_u32(out, c);
+    }
+}
+
+std::vector<AVXPolynomial> read_polys(const uint8_t*& p, uint32_t count, uint32_t n, uint32_t q) {
+    std::vector<AVXPolynomial> polys;
+    polys.reserve(count);
+    AlignedVector<uint32_t> coeffs(n);
+    for (uint32_t i = 0; i < count; ++i) {
+        for (uint32_t j = 0; j < n; ++j, p += 4) {
+            coeffs[j] = read_u32(p);
+            if (coeffs[j] >= q) {
+                throw std::invalid_argument("Coefficient out of range");
+            }
+        }
+        polys.emplace_back(n, q);
+        polys.back().copy_from(coeffs.data());
+    }
+    return polys;
+}
+
+// t1 coefficients have bit_length(q - 1) - d bits
+uint32_t t1_bits(const SignParameters& sp) {
+    return static_cast<uint32_t>(bit_length((SIGN_MODULUS - 1) >> sp.d));
+}
+
+// z coefficients lie in (-gamma1, gamma1], so gamma1 - z needs bit_length(gamma1) bits
+uint32_t z_bits(const SignParameters& sp) {
+    return static_cast<uint32_t>(bit_length(sp.gamma1));
+}
+
+void write_packed(std::vector<uint8_t>& out, const std::vector<AVXPolynomial>& polys, uint32_t bits) {
+    for (const auto& poly : polys) {
+        size_t start = out.size();
+        out.resize(start + packed_poly_bytes(poly.degree(), bits));
+        pack_poly(poly, bits, out.data() + start);
+    }
+}
+
+std::vector<AVXPolynomial> read_packed(const uint8_t*& p, uint32_t count, uint32_t n, uint32_t q,
+                                       uint32_t bits) {
+    std::vector<AVXPolynomial> polys;
+    polys.reserve(count);
+    for (uint32_t i = 0; i < count; ++i, p += packed_poly_bytes(n, bits)) {
+        polys.emplace_back(n, q);
+        unpack_poly(p, bits, polys.back());
+    }
+    return polys;
+}
+
+// Signature vectors with coefficients in (-gamma1, gamma1], stored as gamma1 - z
+void write_packed_offset(std::vector<uint8_t>& out, const std::vector<AVXPolynomial>& polys,
+                         uint32_t offset, uint32_t bits) {
+    for (const auto& poly : polys) {
+        size_t start = out.size();
+        out.resize(start + packed_poly_bytes(poly.degree(), bits));
+        pack_poly_offset(poly, offset, bits, out.data() + start);
+    }
+}
+
+std::vector<AVXPolynomial> read_packed_offset(const uint8_t*& p, uint32_t count, uint32_t n, uint32_t q,
+                                              uint32_t offset, uint32_t bits) {
+    std::vector<AVXPolynomial> polys;
+    polys.reserve(count);
+    for (uint32_t i = 0; i < count; ++i, p += packed_poly_bytes(n, bits)) {
+        polys.emplace_back(n, q);
+        unpack_poly_offset(p, offset, bits, polys.back());
+    }
+    return polys;
+}
+
+// Hints as omega + k bytes: the positions of the ones in each polynomial,
+// followed by the running total after each polynomial
+void write_hints(std::vector<uint8_t>& out, const std::vector<AVXPolynomial>& hints, uint32_t omega) {
+    size_t start = out.size();
+    out.resize(start + omega + hints.size(), 0);
+    uint32_t count = 0;
+    AlignedVector<uint32_t> coeffs;
+    for (size_t i = 0; i < hints.size(); ++i) {
+        if (hints[i].degree() > 256) {
+            throw std::invalid_argument("Hint positions must fit in one byte");
+        }
+        coeffs.resize(hints[i].degree());
+        hints[i].copy_to(coeffs.data());
+        for (uint32_t j = 0; j < coeffs.size(); ++j) {
+            if (coeffs[j] == 0) continue;
+            if (coeffs[j] != 1 || count == omega) {
+                throw std::invalid_argument("Hint must be binary with at most omega ones");
+            }
+            out[start + count++] = static_cast<uint8_t>(j);
+        }
+        out[start + omega + i] = static_cast<uint8_t>(count);
+    }
+}
+
+// Accepts only the unique encoding: non-decreasing totals, strictly
+// increasing positions within a polynomial and zero padding
+std::vector<AVXPolynomial> read_hints(const uint8_t*& p, uint32_t count, uint32_t n, uint32_t q,
+                                      uint32_t omega) {
+    std::vector<AVXPolynomial> hints;
+    hints.reserve(count);
+    AlignedVector<uint32_t> coeffs(n);
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t total = p[omega + i];
+        if (total < prev || total > omega) {
+            throw std::invalid_argument("Malformed hint encoding");
+        }
+        std::fill(coeffs.begin(), coeffs.end(), 0);
+        for (uint32_t j = prev; j < total; ++j) {
+            if ((j > prev && p[j] <= p[j - 1]) || p[j] >= n) {
+                throw std::invalid_argument("Malformed hint encoding");
+            }
+            coeffs[p[j]] = 1;
+        }
+        hints.emplace_back(n, q);
+        hints.back().copy_from(coeffs.data());
+        prev = total;
+    }
+    for (uint32_t j = prev; j < omega; ++j) {
+        if (p[j] != 0) {
+            throw std::invalid_argument("Malformed hint encoding");
+        }
+    }
+    p += omega + count;
+    return hints;
+}
+
+template<size_t N>
+void write_bytes(std::vector<uint8_t>& out, const std::array<uint8_t, N>& bytes) {
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+template<size_t N>
+void read_bytes(const uint8_t*& p, std::array<uint8_t, N>& bytes) {
+    std::memcpy(bytes.data(), p, N);
+    p += N;
+}
+
+// Common header: security level, checked against the expected total length
+const uint8_t* read_header(const std::vector<uint8_t>& data, CLWEParameters& params,
+                           SignParameters& sp, size_t (*expected_size)(const SignParameters&, uint32_t)) {
+    if (data.size() < 4) {
+        throw std::invalid_argument("Truncated encoding");
+    }
+    params = CLWEParameters(read_u32(data.data()));
+    sp = SignParameters::for_security_level(params.security_level);
+    params.modulus = SIGN_MODULUS;
+    if (data.size() != expected_size(sp, params.degree)) {
+        throw std::invalid_argument("Invalid encoding length");
+    }
+    return data.data() + 4;
+}
+
+std::array<uint8_t, 64> hash_message(XOF& xof, const std::array<uint8_t, 64>& tr,
+                                     const std::vector<uint8_t>& message) {
+    std::array<uint8_t, 64> mu;
+    xof.absorb(tr.data(), tr.size());
+    xof.absorb(message.data(), message.size());
+    xof.squeeze(mu.data(), mu.size());
+    return mu;
+}
+
+std::array<uint8_t, 32> hash_challenge(XOF& xof, const std::vector<AVXPolynomial>& w1_polys,
+                                       uint32_t bits, const std::array<uint8_t, 64>& mu) {
+    std::vector<uint8_t> packed;
+    AlignedVector<uint32_t> coeffs(w1_polys.empty() ? 0 : w1_polys[0].degree());
+    for (const auto& poly : w1_polys) {
+        poly.copy_to(coeffs.data());
+        pack_bits(coeffs.data(), coeffs.size(), bits, packed);
+    }
+
+    std::array<uint8_t, 32> c;
+    xof.absorb(mu.data(), mu.size());
+    xof.absorb(packed.data(), packed.size());
+    xof.squeeze(c.data(), c.size());
+    return c;
+}
+
+// Zeroes secret coefficients; OPENSSL_cleanse is not optimized away
+void wipe_polys(std::vector<AVXPolynomial>& polys) {
+    for (auto& poly : polys) {
+        OPENSSL_cleanse(poly.avx_coeffs(), poly.degree() * sizeof(uint32_t));
+    }
+}
+
+// Wipes a signing-local copy of a private key when it goes out of scope
+class PrivateKeyWiper {
+private:
+    SignPrivateKey& key_;
+
+public:
+    explicit PrivateKeyWiper(SignPrivateKey& key) : key_(key) {}
+    ~PrivateKeyWiper() {
+        for (auto* polys : {&key_.s1, &key_.s2, &key_.t0, &key_.s1_ntt, &key_.s2_ntt, &key_.t0_ntt}) {
+            wipe_polys(*polys);
+        }
+        OPENSSL_cleanse(key_.key.data(), key_.key.size());
+    }
+
+    PrivateKeyWiper(const PrivateKeyWiper&) = delete;
+    PrivateKeyWiper& operator=(const PrivateKeyWiper&) = delete;
+};
+
+template<size_t N>
+void random_bytes(std::array<uint8_t, N>& out) {
+    std::random_device rd;
+    for (auto& b : out) {
+        b = static_cast<uint8_t>(rd());
+    }
+}
+
+} // namespace
+
+SignParameters SignParameters::for_security_level(uint32_t security_level) {
+    constexpr uint32_t q = SIGN_MODULUS;
+    switch (security_level) {
+        case 128:
+            return {4, 4, 2, 39, 78, 1u << 17, (q - 1) / 88, 80, 13};
+        case 192:
+            return {6, 5, 4, 49, 196, 1u << 19, (q - 1) / 32, 55, 13};
+        case 256:
+            return {8, 7, 2, 60, 120, 1u << 19, (q - 1) / 32, 75, 13};
+        default:
+            throw std::invalid_argument("Unsupported security level for Sign");
+    }
+}
+
+// Serialization
+
+std::vector<uint8_t> SignPublicKey::serialize() const {
+    CLWE_INSTRUMENT(Serialization);
+    std::vector<uint8_t> out;
+    write_u32(out, params.security_level);
+    write_bytes(out, seed);
+    write_packed(out, public_polys, t1_bits(SignParameters::for_security_level(params.security_level)));
+    return out;
+}
+
+SignPublicKey SignPublicKey::deserialize(const std::vector<uint8_t>& data) {
+    CLWE_INSTRUMENT(Deserialization);
+    SignPublicKey pk;
+    SignParameters sp;
+    const uint8_t* p = read_header(data, pk.params, sp, [](const SignParameters& s, uint32_t n) -> size_t {
+        return 4 + 32 + s.k * packed_poly_bytes(n, t1_bits(s));
+    });
+    read_bytes(p, pk.seed);
+    pk.public_polys = read_packed(p, sp.k, pk.params.degree, SIGN_MODULUS, t1_bits(sp));
+
+    std::vector<uint8_t> digest = xof_expand(EVP_shake256(), data, pk.tr.size());
+    std::copy(digest.begin(), digest.end(), pk.tr.begin());
+    return pk;
+}
+
+std::vector<uint8_t> SignPrivateKey::serialize() const {
+    CLWE_INSTRUMENT(Serialization);
+    std::vector<uint8_t> out;
+    write_u32(out, params.security_level);
+    write_bytes(out, seed);
+    write_bytes(out, key);
+    write_bytes(out, tr);
+    write_polys(out, s1_ntt);
+    write_polys(out, s2_ntt);
+    write_polys(out, t0_ntt);
+    return out;
+}
+
+SignPrivateKey SignPrivateKey::deserialize(const std::vector<uint8_t>& data) {
+    CLWE_INSTRUMENT(Deserialization);
+    SignPrivateKey sk;
+    SignParameters sp;
+    const uint8_t* p = read_header(data, sk.params, sp, [](const SignParameters& s, uint32_t n) -> size_t {
+        return 4 + 32 + 32 + 64 + static_cast<size_t>(s.l + 2 * s.k) * n * 4;
+    });
+    read_bytes(p, sk.seed);
+    read_bytes(p, sk.key);
+    read_bytes(p, sk.tr);
+    sk.s1_ntt = read_polys(p, sp.l, sk.params.degree, SIGN_MODULUS);
+    sk.s2_ntt = read_polys(p, sp.k, sk.params.degree, SIGN_MODULUS);
+    sk.t0_ntt = read_polys(p, sp.k, sk.params.degree, SIGN_MODULUS);
+    return sk;
+}
+
+std::vector<uint8_t> Signature::serialize() const {
+    CLWE_INSTRUMENT(Serialization);
+    SignParameters sp = SignParameters::for_security_level(params.security_level);
+    std::vector<uint8_t> out;
+    write_u32(out, params.security_level);
+    write_bytes(out, c);
+    write_packed_offset(out, z_polys, sp.gamma1, z_bits(sp));
+    write_hints(out, hint_polys, sp.omega);
+    return out;
+}
+
+Signature Signature::deserialize(const std::vector<uint8_t>& data) {
+    CLWE_INSTRUMENT(Deserialization);
+    Signature sig;
+    SignParameters sp;
+    const uint8_t* p = read_header(data, sig.params, sp, [](const SignParameters& s, uint32_t n) -> size_t {
+        return 4 + 32 + s.l * packed_poly_bytes(n, z_bits(s)) + s.omega + s.k;
+    });
+    read_bytes(p, sig.c);
+    sig.z_polys = read_packed_offset(p, sp.l, sig.params.degree, SIGN_MODULUS, sp.gamma1, z_bits(sp));
+    sig.hint_polys = read_hints(p, sp.k, sig.params.degree, SIGN_MODULUS, sp.omega);
+    return sig;
+}
+
+// Sign
+
+// Background producer of message-independent commitments for one private key.
+// Every commitment uses its own mask seed H(K || rnd) and is handed out once.
+class SignCommitmentPool {
+private:
+    const Sign& sign_;
+    std::shared_ptr<const SignMatrix> matrix_A_;
+    std::array<uint8_t, 32> seed_;
+    std::array<uint8_t, 32> key_;
+    size_t capacity_;
+
+    std::deque<SignCommitment> ready_;
+    std::mutex mutex_;
+    std::condition_variable space_available_;
+    bool stop_;
+    std::thread worker_;
+
+    void run() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                space_available_.wait(lock, [this] { return stop_ || ready_.size() < capacity_; });
+                if (stop_) return;
+            }
+            SignCommitment commitment = generate();
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(std::move(commitment));
+        }
+    }
+
+public:
+    SignCommitmentPool(const Sign& sign, std::shared_ptr<const SignMatrix> matrix_A,
+                       const SignPrivateKey& private_key, size_t capacity)
+        : sign_(sign), matrix_A_(std::move(matrix_A)), seed_(private_key.seed),
+          key_(private_key.key), capacity_(capacity), stop_(false) {
+        worker_ = std::thread(&SignCommitmentPool::run, this);
+    }
+
+    ~SignCommitmentPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        space_available_.notify_all();
+        worker_.join();
+    }
+
+    SignCommitmentPool(const SignCommitmentPool&) = delete;
+    SignCommitmentPool& operator=(const SignCommitmentPool&) = delete;
+
+    bool matches(const SignPrivateKey& private_key) const {
+        return private_key.seed == seed_ && private_key.key == key_;
+    }
+
+    SignCommitment generate() const {
+        std::array<uint8_t, 32> rnd;
+        random_bytes(rnd);
+        std::array<uint8_t, 64> rho_prime;
+        XOF xof(EVP_shake256());
+        xof.absorb(key_.data(), key_.size());
+        xof.absorb(rnd.data(), rnd.size());
+        xof.squeeze(rho_prime.data(), rho_prime.size());
+        return sign_.compute_commitment(*matrix_A_, rho_prime, 0);
+    }
+
+    // Pops a ready commitment, or computes one inline when the pool has run dry
+    SignCommitment take() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ready_.empty()) {
+                SignCommitment commitment = std::move(ready_.front());
+                ready_.pop_front();
+                space_available_.notify_one();
+                return commitment;
+            }
+        }
+        return generate();
+    }
+
+    size_t available() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ready_.size();
+    }
+};
+
+// Persistent workers for speculative signing rounds, so a round does not pay
+// for thread creation. Slot 0 of each round runs on the calling thread.
+class SignAttemptPool {
+private:
+    std::vector<std::thread> workers_;
+    std::mutex round_mutex_;    // Held for the duration of one round
+    std::mutex mutex_;
+    std::condition_variable round_started_;
+    std::condition_variable round_done_;
+    const std::function<void(uint32_t)>* task_;
+    std::vector<std::exception_ptr> errors_;
+    uint64_t round_;
+    size_t pending_;
+    bool stop_;
+
+    void run(uint32_t slot) {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(uint32_t)>* task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                round_started_.wait(lock, [&] { return stop_ || round_ != seen; });
+                if (stop_) return;
+                seen = round_;
+                task = task_;
+            }
+            try {
+                (*task)(slot);
+            } catch (...) {
+                errors_[slot] = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) round_done_.notify_one();
+        }
+    }
+
+public:
+    explicit SignAttemptPool(uint32_t slots)
+        : task_(nullptr), errors_(slots), round_(0), pending_(0), stop_(false) {
+        workers_.reserve(slots - 1);
+        for (uint32_t slot = 1; slot < slots; ++slot) {
+            workers_.emplace_back(&SignAttemptPool::run, this, slot);
+        }
+    }
+
+    ~SignAttemptPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        round_started_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    SignAttemptPool(const SignAttemptPool&) = delete;
+    SignAttemptPool& operator=(const SignAttemptPool&) = delete;
+
+    // Runs task(slot) for every slot and rethrows the first failure. Returns
+    // false without running anything while another thread's round is in flight.
+    bool try_run(const std::function<void(uint32_t)>& task) {
+        std::unique_lock<std::mutex> round(round_mutex_, std::try_to_lock);
+        if (!round.owns_lock()) return false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::fill(errors_.begin(), errors_.end(), nullptr);
+            task_ = &task;
+            pending_ = workers_.size();
+            ++round_;
+        }
+        round_started_.notify_all();
+
+        try {
+            task(0);
+        } catch (...) {
+            errors_[0] = std::current_exception();
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            round_done_.wait(lock, [this] { return pending_ == 0; });
+        }
+        for (const auto& error : errors_) {
+            if (error) std::rethrow_exception(error);
+        }
+        return true;
+    }
+};
+
+Sign::Sign(const CLWEParameters& params)
+    : params_(params), sign_params_(SignParameters::for_security_level(params.security_level)),
+      rounding_(SIGN_MODULUS, sign_params_.gamma2, sign_params_.d), parallel_attempts_(1),
+      sparse_challenge_(sign_params_.tau <= SPARSE_CHALLENGE_MAX_WEIGHT) {
+    params_.modulus = SIGN_MODULUS;
+    ntt_engine_ = create_tuned_avx_engine(params_.modulus, params_.degree);
+}
+
+Sign::~Sign() = default;
+
+void Sign::start_precomputation(const SignPrivateKey& private_key, size_t capacity) {
+    if (capacity == 0) {
+        // y, w and w1 of one commitment
+        const size_t commitment_bytes = static_cast<size_t>(sign_params_.l + 2 * sign_params_.k) *
+                                        params_.degree * sizeof(uint32_t);
+        capacity = CPUFeatureDetector::cached().topology.items_per_cache(commitment_bytes, 2);
+    }
+    std::shared_ptr<const SignMatrix> A = private_key.matrix_A;
+    if (!A) {
+        A = std::make_shared<const SignMatrix>(expand_matrix(private_key.seed));
+    }
+
+    auto pool = std::make_shared<SignCommitmentPool>(*this, std::move(A), private_key, capacity);
+    std::lock_guard<std::mutex> lock(pools_mutex_);
+    pools_[private_key.key] = std::move(pool);
+}
+
+void Sign::stop_precomputation(const SignPrivateKey& private_key) {
+    std::lock_guard<std::mutex> lock(pools_mutex_);
+    pools_.erase(private_key.key);
+}
+
+size_t Sign::precomputed_commitments(const SignPrivateKey& private_key) const {
+    std::lock_guard<std::mutex> lock(pools_mutex_);
+    auto it = pools_.find(private_key.key);
+    return (it != pools_.end() && it->second->matches(private_key)) ? it->second->available() : 0;
+}
+
+std::shared_ptr<SignCommitmentPool> Sign::find_pool(const SignPrivateKey& private_key) const {
+    std::lock_guard<std::mutex> lock(pools_mutex_);
+    auto it = pools_.find(private_key.key);
+    return (it != pools_.end() && it->second->matches(private_key)) ? it->second : nullptr;
+}
+
+SignMatrix Sign::expand_matrix(const std::array<uint8_t, 32>& seed) const {
+    CLWE_INSTRUMENT(MatrixExpansion);
+    const uint32_t n = params_.degree;
+    const uint32_t q = params_.modulus;
+    SignMatrix A(sign_params_.k);
+    AlignedVector<uint32_t> coeffs(n);
+
+    for (uint32_t i = 0; i < sign_params_.k; ++i) {
+        A[i].reserve(sign_params_.l);
+        for (uint32_t j = 0; j < sign_params_.l; ++j) {
+            std::vector<uint8_t> input = seed_with_nonce(seed, static_cast<uint16_t>((i << 8) | j));
+
+            // Uniform 23-bit rejection; sampled directly in the NTT domain
+            uint32_t count = 0;
+            size_t len = 5 * 168;
+            while (count < n) {
+                std::vector<uint8_t> buf = xof_expand(EVP_shake128(), input, len);
+                count = 0;
+                for (size_t pos = 0; pos + 3 <= buf.size() && count < n; pos += 3) {
+                    uint32_t t = (static_cast<uint32_t>(buf[pos]) |
+                                  (static_cast<uint32_t>(buf[pos + 1]) << 8) |
+                                  (static_cast<uint32_t>(buf[pos + 2]) << 16)) & 0x7FFFFF;
+                    if (t < q) coeffs[count++] = t;
+                }
+                len *= 2;
+            }
+
+            A[i].emplace_back(n, q);
+            A[i].back().copy_from(coeffs.data());
+        }
+    }
+    return A;
+}
+
+std::vector<AVXPolynomial> Sign::sample_secret(const std::array<uint8_t, 64>& seed, uint16_t nonce,
+                                               uint32_t count) const {
+    const uint32_t n = params_.degree;
+    const uint32_t q = params_.modulus;
+    const uint32_t eta = sign_params_.eta;
+    // Half-byte rejection: accept the largest multiple of 2*eta+1 below 16
+    const uint32_t limit = 16 - 16 % (2 * eta + 1);
+
+    std::vector<AVXPolynomial> polys;
+    polys.reserve(count);
+    AlignedVector<uint32_t> coeffs(n);
+
+    for (uint32_t p = 0; p < count; ++p) {
+        std::vector<uint8_t> input = seed_with_nonce(seed, static_cast<uint16_t>(nonce + p));
+        uint32_t filled = 0;
+        size_t len = 136;
+        while (filled < n) {
+            std::vector<uint8_t> buf = xof_expand(EVP_shake256(), input, len);
+            filled = 0;
+            for (size_t pos = 0; pos < buf.size() && filled < n; ++pos) {
+                uint32_t halves[2] = {static_cast<uint32_t>(buf[pos] & 0x0F),
+                                      static_cast<uint32_t>(buf[pos] >> 4)};
+                for (uint32_t t : halves) {
+                    if (t < limit && filled < n) {
+                        coeffs[filled++] = to_field(static_cast<int64_t>(eta) - t % (2 * eta + 1), q);
+                    }
+                }
+            }
+            len *= 2;
+        }
+        polys.emplace_back(n, q);
+        polys.back().copy_from(coeffs.data());
+    }
+    return polys;
+}
+
+std::vector<AVXPolynomial> Sign::sample_mask(const std::array<uint8_t, 64>& seed, uint16_t nonce) const {
+    CLWE_INSTRUMENT(Sampling);
+    const uint32_t n = params_.degree;
+    const uint32_t q = params_.modulus;
+    const uint32_t gamma1 = sign_params_.gamma1;
+    const uint32_t bits = static_cast<uint32_t>(bit_length(gamma1));  // log2(gamma1) + 1
+
+    std::vector<AVXPolynomial> polys;
+    polys.reserve(sign_params_.l);
+    AlignedVector<uint32_t> coeffs(n);
+
+    for (uint32_t p = 0; p < sign_params_.l; ++p) {
+        std::vector<uint8_t> input = seed_with_nonce(seed, static_cast<uint16_t>(nonce + p));
+        std::vector<uint8_t> buf = xof_expand(EVP_shake256(), input, (static_cast<size_t>(n) * bits + 7) / 8);
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t t = read_bits(buf.data(), static_cast<size_t>(i) * bits, bits);
+            coeffs[i] = to_field(static_cast<int64_t>(gamma1) - t, q);
+        }
+        polys.emplace_back(n, q);
+        polys.back().copy_from(coeffs.data());
+    }
+    return polys;
+}
+
+SparseTernaryPoly Sign::sample_challenge(const std::array<uint8_t, 32>& c) const {
+    CLWE_INSTRUMENT(Sampling);
+    const uint32_t n = params_.degree;
+    const uint32_t q = params_.modulus;
+    const uint32_t tau = sign_params_.tau;
+    std::vector<uint8_t> input(c.begin(), c.end());
+    AlignedVector<uint32_t> coeffs(n, 0);
+
+    // Fisher-Yates style: the first 8 bytes give the signs, the rest pick positions
+    size_t len = 136;
+    for (;;) {
+        std::vector<uint8_t> buf = xof_expand(EVP_shake256(), input, len);
+        std::fill(coeffs.begin(), coeffs.end(), 0);
+        uint64_t signs = 0;
+        for (int b = 0; b < 8; ++b) {
+            signs |= static_cast<uint64_t>(buf[b]) << (8 * b);
+        }
+
+        size_t pos = 8;
+        uint32_t i = n - tau;
+        for (; i < n; ++i) {
+            uint32_t j = n;
+            while (pos < buf.size() && (j = buf[pos++]) > i) {
+            }
+            if (j > i) break;
+
+            coeffs[i] = coeffs[j];
+            coeffs[j] = (signs & 1) ? q - 1 : 1;
+            signs >>= 1;
+        }
+        if (i == n) break;
+        len *= 2;
+    }
+
+    SparseTernaryPoly challenge(n, q);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (coeffs[i] != 0) challenge.add_term(i, coeffs[i] != 1);
+    }
+    return challenge;
+}
+
+SignChallenge Sign::make_challenge(const std::array<uint8_t, 32>& c) const {
+    SignChallenge challenge{sample_challenge(c), AVXPolynomial(params_.degree, params_.modulus)};
+    if (!sparse_challenge_) {
+        challenge.ntt = challenge.sparse.to_polynomial();
+        ntt_engine_->ntt_forward_avx(challenge.ntt.avx_coeffs());
+    }
+    return challenge;
+}
+
+void Sign::to_ntt(std::vector<AVXPolynomial>& polys) const {
+    for (auto& poly : polys) {
+        ntt_engine_->ntt_forward_avx(poly.avx_coeffs());
+    }
+}
+
+std::vector<AVXPolynomial> Sign::matrix_vector_ntt(const SignMatrix& A,
+                                                   const std::vector<AVXPolynomial>& v_ntt) const {
+    std::vector<AVXPolynomial> result;
+    result.reserve(A.size());
+    for (const auto& row : A) {
+        result.emplace_back(params_.degree, params_.modulus);
+        __m256i* acc = result.back().avx_coeffs();
+        ntt_engine_->pointwise_multiply_avx(row[0].avx_coeffs(), v_ntt[0].avx_coeffs(), acc);
+        for (size_t j = 1; j < row.size(); ++j) {
+            ntt_engine_->pointwise_multiply_acc_avx(row[j].avx_coeffs(), v_ntt[j].avx_coeffs(), acc);
+        }
+        ntt_engine_->ntt_inverse_avx(acc);
+    }
+    return result;
+}
+
+std::vector<AVXPolynomial> Sign::challenge_product(const SignChallenge& c,
+                                                   const std::vector<AVXPolynomial>& v,
+                                                   const std::vector<AVXPolynomial>& v_ntt) const {
+    std::vector<AVXPolynomial> result;
+    const size_t count = sparse_challenge_ ? v.size() : v_ntt.size();
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.emplace_back(params_.degree, params_.modulus);
+        if (sparse_challenge_) {
+            c.sparse.multiply(v[i], result.back());
+        } else {
+            ntt_engine_->pointwise_multiply_avx(c.ntt.avx_coeffs(), v_ntt[i].avx_coeffs(),
+                                                result.back().avx_coeffs());
+            ntt_engine_->ntt_inverse_avx(result.back().avx_coeffs());
+        }
+    }
+    return result;
+}
+
+void Sign::expand_public_key(SignPublicKey& public_key) const {
+    if (!public_key.matrix_A) {
+        public_key.matrix_A = std::make_shared<const SignMatrix>(expand_matrix(public_key.seed));
+    }
+}
+
+void Sign::expand_private_key(SignPrivateKey& private_key) const {
+    if (!private_key.matrix_A) {
+        private_key.matrix_A = std::make_shared<const SignMatrix>(expand_matrix(private_key.seed));
+    }
+
+    // Coefficient-form secrets for the sparse challenge product
+    auto from_ntt = [this](const std::vector<AVXPolynomial>& ntt) {
+        std::vector<AVXPolynomial> plain = ntt;
+        for (auto& poly : plain) {
+            ntt_engine_->ntt_inverse_avx(poly.avx_coeffs());
+        }
+        return plain;
+    };
+    if (private_key.s1.size() != private_key.s1_ntt.size()) private_key.s1 = from_ntt(private_key.s1_ntt);
+    if (private_key.s2.size() != private_key.s2_ntt.size()) private_key.s2 = from_ntt(private_key.s2_ntt);
+    if (private_key.t0.size() != private_key.t0_ntt.size()) private_key.t0 = from_ntt(private_key.t0_ntt);
+}
+
+std::pair<SignPublicKey, SignPrivateKey> Sign::keygen() {
+    CLWE_INSTRUMENT(KeyGen);
+    std::array<uint8_t, 32> zeta;
+    random_bytes(zeta);
+
+    // (rho, rho', K) = H(zeta)
+    std::vector<uint8_t> seeds = xof_expand(EVP_shake256(), std::vector<uint8_t>(zeta.begin(), zeta.end()), 128);
+    std::array<uint8_t, 32> rho;
+    std::array<uint8_t, 64> rho_prime;
+    std::array<uint8_t, 32> key;
+    std::copy(seeds.begin(), seeds.begin() + 32, rho.begin());
+    std::copy(seeds.begin() + 32, seeds.begin() + 96, rho_prime.begin());
+    std::copy(seeds.begin() + 96, seeds.end(), key.begin());
+
+    auto A = std::make_shared<const SignMatrix>(expand_matrix(rho));
+    std::vector<AVXPolynomial> s1 = sample_secret(rho_prime, 0, sign_params_.l);
+    std::vector<AVXPolynomial> s2 = sample_secret(rho_prime, static_cast<uint16_t>(sign_params_.l), sign_params_.k);
+
+    std::vector<AVXPolynomial> s1_ntt = s1;
+    to_ntt(s1_ntt);
+    std::vector<AVXPolynomial> t = matrix_vector_ntt(*A, s1_ntt);
+    for (uint32_t i = 0; i < sign_params_.k; ++i) {
+        t[i] = t[i] + s2[i];
+    }
+
+    std::vector<AVXPolynomial> t1, t0;
+    rounding_.power2round(t, t1, t0);
+
+    SignPublicKey public_key;
+    public_key.seed = rho;
+    public_key.public_polys = std::move(t1);
+    public_key.matrix_A = A;
+    public_key.params = params_;
+
+    std::vector<uint8_t> tr = xof_expand(EVP_shake256(), public_key.serialize(), public_key.tr.size());
+    std::copy(tr.begin(), tr.end(), public_key.tr.begin());
+
+    SignPrivateKey private_key;
+    private_key.seed = rho;
+    private_key.key = key;
+    private_key.tr = public_key.tr;
+    private_key.s1 = std::move(s1);
+    private_key.s2 = std::move(s2);
+    private_key.t0 = std::move(t0);
+    private_key.s1_ntt = std::move(s1_ntt);
+    private_key.s2_ntt = private_key.s2;
+    to_ntt(private_key.s2_ntt);
+    private_key.t0_ntt = private_key.t0;
+    to_ntt(private_key.t0_ntt);
+    private_key.matrix_A = A;
+    private_key.params = params_;
+
+    return {std::move(public_key), std::move(private_key)};
+}
+
+SignCommitment Sign::compute_commitment(const SignMatrix& A, const std::array<uint8_t, 64>& rho_prime,
+                                        uint16_t kappa) const {
+    SignCommitment commitment;
+    commitment.y = sample_mask(rho_prime, kappa);
+    std::vector<AVXPolynomial> y_ntt = commitment.y;
+    to_ntt(y_ntt);
+
+    commitment.w = matrix_vector_ntt(A, y_ntt);
+    commitment.w1 = rounding_.high_bits(commitment.w);
+    return commitment;
+}
+
+bool Sign::respond(const SignPrivateKey& private_key, const SignCommitment& commitment,
+                   const std::array<uint8_t, 64>& mu, Signature& signature) const {
+    const uint32_t z_bound = sign_params_.gamma1 - sign_params_.beta;
+    const uint32_t r0_bound = sign_params_.gamma2 - sign_params_.beta;
+
+    signature.c = compute_challenge(commitment.w1, mu);
+    SignChallenge c = make_challenge(signature.c);
+
+    // z = y + c*s1
+    std::vector<AVXPolynomial> cs1 = challenge_product(c, private_key.s1, private_key.s1_ntt);
+    for (uint32_t i = 0; i < sign_params_.l; ++i) {
+        cs1[i] = commitment.y[i] + cs1[i];
+    }
+    if (polys_exceed_norm(cs1, z_bound)) return false;
+
+    // r = w - c*s2
+    std::vector<AVXPolynomial> r = challenge_product(c, private_key.s2, private_key.s2_ntt);
+    for (uint32_t i = 0; i < sign_params_.k; ++i) {
+        r[i] = commitment.w[i] - r[i];
+    }
+    if (polys_exceed_norm(rounding_.low_bits(r), r0_bound)) return false;
+
+    std::vector<AVXPolynomial> ct0 = challenge_product(c, private_key.t0, private_key.t0_ntt);
+    if (polys_exceed_norm(ct0, sign_params_.gamma2)) return false;
+
+    // Hints recover HighBits(w) from w - c*s2 + c*t0
+    std::vector<AVXPolynomial> neg_ct0;
+    neg_ct0.reserve(sign_params_.k);
+    for (uint32_t i = 0; i < sign_params_.k; ++i) {
+        r[i] = r[i] + ct0[i];
+        neg_ct0.emplace_back(-ct0[i]);
+    }
+    if (rounding_.make_hint(neg_ct0, r, signature.hint_polys) > sign_params_.omega) return false;
+
+    signature.z_polys = std::move(cs1);
+    signature.params = params_;
+    return true;
+}
+
+void Sign::set_parallel_attempts(uint32_t attempts) {
+    if (attempts == 0) {
+        attempts = CPUFeatureDetector::cached().topology.default_thread_count();
+    }
+    if (attempts != parallel_attempts_) {
+        attempt_pool_ = attempts > 1 ? std::make_unique<SignAttemptPool>(attempts) : nullptr;
+    }
+    parallel_attempts_ = attempts;
+}
+
+Signature Sign::sign(const SignPrivateKey& private_key, const std::vector<uint8_t>& message) {
+    return sign_digest(private_key, compute_message_digest(private_key.tr, message));
+}
+
+Signature Sign::sign_file(const SignPrivateKey& private_key, const std::string& path) {
+    return sign_digest(private_key, hash_file(private_key.tr, path));
+}
+
+Signature Sign::sign_digest(const SignPrivateKey& signing_key, const std::array<uint8_t, 64>& mu) {
+    CLWE_INSTRUMENT(Sign);
+    if (signing_key.s1_ntt.size() != sign_params_.l || signing_key.s2_ntt.size() != sign_params_.k ||
+        signing_key.t0_ntt.size() != sign_params_.k) {
+        throw std::invalid_argument("Private key does not match signing parameters");
+    }
+
+    // Deserialized keys lack the coefficient-form secrets the sparse path needs.
+    // Sign does not keep secrets: callers signing repeatedly run
+    // expand_private_key() once, otherwise a wiped temporary copy is expanded.
+    SignPrivateKey expanded;
+    PrivateKeyWiper wiper(expanded);
+    const bool needs_expansion = sparse_challenge_ && signing_key.s1.size() != sign_params_.l;
+    if (needs_expansion) {
+        expanded = signing_key;
+        expand_private_key(expanded);
+    }
+    const SignPrivateKey& private_key = needs_expansion ? expanded : signing_key;
+
+    // Online phase: only the challenge, response and rejection checks remain
+    if (std::shared_ptr<SignCommitmentPool> pool = find_pool(private_key)) {
+        Signature signature;
+        for (uint32_t attempt = 0; attempt < MAX_SIGN_ATTEMPTS; ++attempt) {
+            if (respond(private_key, pool->take(), mu, signature)) {
+                return signature;
+            }
+        }
+        throw std::runtime_error("Signing did not converge");
+    }
+
+    std::shared_ptr<const SignMatrix> A = private_key.matrix_A;
+    if (!A) {
+        A = std::make_shared<const SignMatrix>(expand_matrix(private_key.seed));
+    }
+
+    // rho' = H(K || rnd || mu), hedged with fresh randomness
+    std::array<uint8_t, 32> rnd;
+    random_bytes(rnd);
+    std::array<uint8_t, 64> rho_prime;
+    {
+        XOF xof(EVP_shake256());
+        xof.absorb(private_key.key.data(), private_key.key.size());
+        xof.absorb(rnd.data(), rnd.size());
+        xof.absorb(mu.data(), mu.size());
+        xof.squeeze(rho_prime.data(), rho_prime.size());
+    }
+
+    const uint32_t l = sign_params_.l;
+    const uint32_t parallel = parallel_attempts_;
+
+    if (parallel <= 1) {
+        Signature signature;
+        for (uint32_t attempt = 0; attempt < MAX_SIGN_ATTEMPTS; ++attempt) {
+            SignCommitment commitment = compute_commitment(*A, rho_prime, static_cast<uint16_t>(attempt * l));
+            if (respond(private_key, commitment, mu, signature)) {
+                return signature;
+            }
+        }
+    } else {
+        // Speculative rounds: attempts base..base+parallel-1 run concurrently and the
+        // lowest accepted index wins, so the result equals the sequential one.
+        // A round that finds the pool busy with another caller runs its slots inline.
+        std::vector<Signature> candidates(parallel);
+        std::vector<uint8_t> accepted(parallel);
+        uint32_t base = 0;
+        const std::function<void(uint32_t)> attempt = [&](uint32_t slot) {
+            SignCommitment commitment = compute_commitment(*A, rho_prime,
+                                                           static_cast<uint16_t>((base + slot) * l));
+            accepted[slot] = respond(private_key, commitment, mu, candidates[slot]);
+        };
+        for (; base < MAX_SIGN_ATTEMPTS; base += parallel) {
+            if (!attempt_pool_->try_run(attempt)) {
+                for (uint32_t slot = 0; slot < parallel; ++slot) {
+                    attempt(slot);
+                }
+            }
+
+            for (uint32_t slot = 0; slot < parallel; ++slot) {
+                if (accepted[slot]) {
+                    return std::move(candidates[slot]);
+                }
+            }
+        }
+    }
+
+    throw std::runtime_error("Signing did not converge");
+}
+
+bool Sign::signature_well_formed(const SignPublicKey& public_key, const Signature& signature) const {
+    if (public_key.public_polys.size() != sign_params_.k ||
+        signature.z_polys.size() != sign_params_.l ||
+        signature.hint_polys.size() != sign_params_.k) {
+        return false;
+    }
+
+    if (polys_exceed_norm(signature.z_polys, sign_params_.gamma1 - sign_params_.beta)) {
+        return false;
+    }
+
+    // Hints must be 0/1 and at most omega of them
+    uint32_t hint_count = 0;
+    AlignedVector<uint32_t> coeffs(params_.degree);
+    for (const auto& h : signature.hint_polys) {
+        h.copy_to(coeffs.data());
+        for (uint32_t c : coeffs) {
+            if (c > 1) return false;
+            hint_count += c;
+        }
+    }
+    return hint_count <= sign_params_.omega;
+}
+
+void Sign::scaled_t1(const SignPublicKey& public_key, std::vector<AVXPolynomial>& t1,
+                     std::vector<AVXPolynomial>& t1_ntt) const {
+    t1.clear();
+    t1.reserve(sign_params_.k);
+    for (const auto& poly : public_key.public_polys) {
+        t1.emplace_back((1u << sign_params_.d) * poly);
+    }
+    t1_ntt.clear();
+    if (!sparse_challenge_) {
+        t1_ntt = t1;
+        to_ntt(t1_ntt);
+    }
+}
+
+bool Sign::verify(const SignPublicKey& public_key, const std::vector<uint8_t>& message,
+                  const Signature& signature) const {
+    return verify_digest(public_key, compute_message_digest(public_key.tr, message), signature);
+}
+
+bool Sign::verify_file(const SignPublicKey& public_key, const std::string& path,
+                       const Signature& signature) const {
+    // Reject malformed signatures before reading the file
+    if (!signature_well_formed(public_key, signature)) {
+        return false;
+    }
+    return verify_well_formed(public_key, hash_file(public_key.tr, path), signature);
+}
+
+bool Sign::verify_digest(const SignPublicKey& public_key, const std::array<uint8_t, 64>& mu,
+                         const Signature& signature) const {
+    if (!signature_well_formed(public_key, signature)) {
+        return false;
+    }
+    return verify_well_formed(public_key, mu, signature);
+}
+
+bool Sign::verify_well_formed(const SignPublicKey& public_key, const std::array<uint8_t, 64>& mu,
+                              const Signature& signature) const {
+    CLWE_INSTRUMENT(Verify);
+    std::shared_ptr<const SignMatrix> A = public_key.matrix_A;
+    if (!A) {
+        A = std::make_shared<const SignMatrix>(expand_matrix(public_key.seed));
+    }
+
+    SignChallenge c = make_challenge(signature.c);
+
+    std::vector<AVXPolynomial> z_ntt = signature.z_polys;
+    to_ntt(z_ntt);
+
+    // w' = A*z - c*t1*2^d
+    std::vector<AVXPolynomial> t1, t1_ntt;
+    scaled_t1(public_key, t1, t1_ntt);
+    std::vector<AVXPolynomial> ct1 = challenge_product(c, t1, t1_ntt);
+    std::vector<AVXPolynomial> w_approx = matrix_vector_ntt(*A, z_ntt);
+    for (uint32_t i = 0; i < sign_params_.k; ++i) {
+        w_approx[i] = w_approx[i] - ct1[i];
+    }
+
+    std::vector<AVXPolynomial> w1 = rounding_.use_hint(signature.hint_polys, w_approx);
+    return compute_challenge(w1, mu) == signature.c;
+}
+
+std::vector<uint64_t> Sign::verify_batch(const std::vector<SignVerifyItem>& items) const {
+    CLWE_INSTRUMENT(Verify);
+    std::vector<uint64_t> results((items.size() + 63) / 64, 0);
+
+    // Group well-formed items by matrix seed so each A is expanded once
+    std::map<std::array<uint8_t, 32>, std::vector<size_t>> groups;
+    for (size_t idx = 0; idx < items.size(); ++idx) {
+        const SignVerifyItem& item = items[idx];
+        if (item.public_key && item.message && item.signature &&
+            signature_well_formed(*item.public_key, *item.signature)) {
+            groups[item.public_key->seed].push_back(idx);
+        }
+    }
+
+    // One hashing context serves every digest and challenge in the batch
+    XOF xof(EVP_shake256());
+    const uint32_t bits = w1_bits();
+    const uint32_t k = sign_params_.k;
+    const uint32_t l = sign_params_.l;
+
+    // z_ntt and w of every signature in a block stay in L2 while A streams past
+    const size_t block_item_bytes = static_cast<size_t>(k + l) * params_.degree * sizeof(uint32_t);
+    const size_t block = std::min(VERIFY_BATCH_MAX_BLOCK,
+                                  std::max(VERIFY_BATCH_MIN_BLOCK,
+                                           CPUFeatureDetector::cached().topology.items_per_cache(block_item_bytes, 2)));
+
+    for (const auto& group : groups) {
+        const std::vector<size_t>& members = group.second;
+
+        std::shared_ptr<const SignMatrix> A;
+        for (size_t idx : members) {
+            if (items[idx].public_key->matrix_A) {
+                A = items[idx].public_key->matrix_A;
+                break;
+            }
+        }
+        if (!A) {
+            A = std::make_shared<const SignMatrix>(expand_matrix(group.first));
+        }
+
+        // t1 * 2^d (and its NTT on the dense challenge path) per distinct key
+        std::map<const SignPublicKey*, std::pair<std::vector<AVXPolynomial>, std::vector<AVXPolynomial>>> t1_cache;
+
+        for (size_t start = 0; start < members.size(); start += block) {
+            const size_t count = std::min(block, members.size() - start);
+
+            std::vector<std::vector<AVXPolynomial>> z_ntt(count);
+            std::vector<std::vector<AVXPolynomial>> w(count);
+            for (size_t b = 0; b < count; ++b) {
+                const SignVerifyItem& item = items[members[start + b]];
+                w[b].reserve(k);
+                for (uint32_t i = 0; i < k; ++i) {
+                    w[b].emplace_back(params_.degree, params_.modulus);
+                }
+
+                z_ntt[b] = item.signature->z_polys;
+                to_ntt(z_ntt[b]);
+            }
+
+            // Blocked A * [z_0 ... z_count-1]: each A[i][j] is loaded once per block
+            for (uint32_t i = 0; i < k; ++i) {
+                for (uint32_t j = 0; j < l; ++j) {
+                    const __m256i* a = (*A)[i][j].avx_coeffs();
+                    for (size_t b = 0; b < count; ++b) {
+                        ntt_engine_->pointwise_multiply_acc_avx(a, z_ntt[b][j].avx_coeffs(), w[b][i].avx_coeffs());
+                    }
+                }
+            }
+
+            for (size_t b = 0; b < count; ++b) {
+                const size_t idx = members[start + b];
+                const SignVerifyItem& item = items[idx];
+                auto cached = t1_cache.find(item.public_key);
+                if (cached == t1_cache.end()) {
+                    cached = t1_cache.emplace(item.public_key, std::make_pair(std::vector<AVXPolynomial>(),
+                                                                              std::vector<AVXPolynomial>())).first;
+                    scaled_t1(*item.public_key, cached->second.first, cached->second.second);
+                }
+                std::vector<AVXPolynomial> ct1 = challenge_product(make_challenge(item.signature->c),
+                                                                   cached->second.first, cached->second.second);
+                for (uint32_t i = 0; i < k; ++i) {
+                    ntt_engine_->ntt_inverse_avx(w[b][i].avx_coeffs());
+                    w[b][i] = w[b][i] - ct1[i];
+                }
+
+                xof.reset();
+                std::array<uint8_t, 64> mu = hash_message(xof, item.public_key->tr, *item.message);
+                std::vector<AVXPolynomial> w1 = rounding_.use_hint(item.signature->hint_polys, w[b]);
+                xof.reset();
+                if (hash_challenge(xof, w1, bits, mu) == item.signature->c) {
+                    results[idx / 64] |= uint64_t(1) << (idx % 64);
+                }
+            }
+        }
+    }
+
+    return results;
+}
+
+bool Sign::verify_keypair(const SignPublicKey& public_key, const SignPrivateKey& private_key) const {
+    if (public_key.seed != private_key.seed || public_key.tr != private_key.tr ||
+        public_key.public_polys.size() != sign_params_.k ||
+        private_key.s1_ntt.size() != sign_params_.l || private_key.s2_ntt.size() != sign_params_.k) {
+        return false;
+    }
+
+    std::shared_ptr<const SignMatrix> A = private_key.matrix_A;
+    if (!A) {
+        A = std::make_shared<const SignMatrix>(expand_matrix(private_key.seed));
+    }
+
+    // t = A*s1 + s2 must round to the published t1
+    std::vector<AVXPolynomial> t = matrix_vector_ntt(*A, private_key.s1_ntt);
+    for (uint32_t i = 0; i < sign_params_.k; ++i) {
+        AVXPolynomial s2 = private_key.s2_ntt[i];
+        ntt_engine_->ntt_inverse_avx(s2.avx_coeffs());
+        t[i] = t[i] + s2;
+    }
+
+    std::vector<AVXPolynomial> t1, t0;
+    rounding_.power2round(t, t1, t0);
+
+    const uint32_t n = params_.degree;
+    AlignedVector<uint32_t> expected(n), actual(n);
+    for (uint32_t i = 0; i < sign_params_.k; ++i) {
+        t1[i].copy_to(expected.data());
+        public_key.public_polys[i].copy_to(actual.data());
+        if (expected != actual) return false;
+    }
+    return true;
+}
+
+// Streaming message hasher
+
+struct SignMessageHasher::Impl {
+    XOF xof;
+    bool finished;
+
+    Impl() : xof(EVP_shake256()), finished(false) {}
+};
+
+SignMessageHasher::SignMessageHasher(const std::array<uint8_t, 64>& tr)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->xof.absorb(tr.data(), tr.size());
+}
+
+SignMessageHasher::~SignMessageHasher() = default;
+
+void SignMessageHasher::init(const std::array<uint8_t, 64>& tr) {
+    impl_->xof.reset();
+    impl_->finished = false;
+    impl_->xof.absorb(tr.data(), tr.size());
+}
+
+void SignMessageHasher::update(const uint8_t* data, size_t len) {
+    if (impl_->finished) {
+        throw std::logic_error("Message hasher already finalized");
+    }
+    impl_->xof.absorb(data, len);
+}
+
+std::array<uint8_t, 64> SignMessageHasher::final() {
+    if (impl_->finished) {
+        throw std::logic_error("Message hasher already finalized");
+    }
+    std::array<uint8_t, 64> mu;
+    impl_->xof.squeeze(mu.data(), mu.size());
+    impl_->finished = true;
+    return mu;
+}
+
+std::array<uint8_t, 64> Sign::hash_file(const std::array<uint8_t, 64>& tr, const std::string& path) const {
+    SignMessageHasher hasher(tr);
+
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if (S_ISREG(st.st_mode) && size > 0) {
+        // Map a window at a time; sequential readahead overlaps I/O with hashing
+        for (size_t offset = 0; offset < size; offset += FILE_HASH_WINDOW) {
+            size_t len = std::min(FILE_HASH_WINDOW, size - offset);
+            void* map = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(offset));
+            if (map == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map file: " + path);
+            }
+            ::madvise(map, len, MADV_SEQUENTIAL);
+            hasher.update(static_cast<const uint8_t*>(map), len);
+            ::munmap(map, len);
+        }
+        ::close(fd);
+        return hasher.final();
+    }
+    ::close(fd);
+#endif
+
+    // Chunked reads for pipes and platforms without mmap
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    std::vector<uint8_t> chunk(FILE_HASH_CHUNK);
+    while (in) {
+        in.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+        hasher.update(chunk.data(), static_cast<size_t>(in.gcount()));
+    }
+    if (in.bad()) {
+        throw std::runtime_error("Error reading file: " + path);
+    }
+    return hasher.final();
+}
+
+std::array<uint8_t, 64> Sign::compute_message_digest(const std::array<uint8_t, 64>& tr,
+                                                     const std::vector<uint8_t>& message) const {
+    XOF xof(EVP_shake256());
+    return hash_message(xof, tr, message);
+}
+
+std::array<uint8_t, 32> Sign::compute_challenge(const std::vector<AVXPolynomial>& w1_polys,
+                                                const std::array<uint8_t, 64>& mu) const {
+    XOF xof(EVP_shake256());
+    return hash_challenge(xof, w1_polys, w1_bits(), mu);
+}
+
+uint32_t Sign::w1_bits() const {
+    // w1 coefficients lie in [0, (q-1)/(2*gamma2)) and are packed tightly
+    return static_cast<uint32_t>(bit_length((params_.modulus - 1) / (2 * sign_params_.gamma2) - 1));
+}
+
+bool Sign::polys_exceed_norm(const std::vector<AVXPolynomial>& polys, uint32_t bound) const {
+    for (const auto& poly : polys) {
+        if (poly.exceeds_norm(bound)) return true;
+    }
+    return false;
+}
+
+int Sign::poly_infty_norm(const std::vector<AVXPolynomial>& polys) const {
+    uint32_t norm = 0;
+    for (const auto& poly : polys) {
+        norm = std::max(norm, poly.infinity_norm());
+    }
+    return static_cast<int>(norm);
+}
+
+} // namespace clwe
@@ -0,0 +1,117 @@
+#include "sparse_poly.hpp"
+#include "poly_expr.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace clwe {
+
+namespace {
+
+inline __m256i load_unaligned(const uint32_t* p) {
+#ifdef HAVE_AVX2
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+#else
+    __m256i r;
+    for (int j = 0; j < 8; ++j) r.m[j] = p[j];
+    return r;
+#endif
+}
+
+} // namespace
+
+SparseTernaryPoly::SparseTernaryPoly(uint32_t degree, uint32_t modulus)
+    : degree_(degree), modulus_(modulus) {
+    if (degree == 0 || degree % 8 != 0) {
+        throw std::invalid_argument("Degree must be a positive multiple of 8");
+    }
+}
+
+void SparseTernaryPoly::add_term(uint32_t position, bool negative) {
+    if (position >= degree_) {
+        throw std::invalid_argument("Term position out of range");
+    }
+    positions_.push_back(position);
+    negative_.push_back(negative ? 1 : 0);
+}
+
+SparseTernaryPoly SparseTernaryPoly::from_polynomial(const AVXPolynomial& poly) {
+    SparseTernaryPoly sparse(poly.degree(), poly.modulus());
+    AlignedVector<uint32_t> coeffs(poly.degree());
+    poly.copy_to(coeffs.data());
+    for (uint32_t i = 0; i < poly.degree(); ++i) {
+        if (coeffs[i] == 0) continue;
+        if (coeffs[i] != 1 && coeffs[i] != poly.modulus() - 1) {
+            throw std::invalid_argument("Polynomial is not ternary");
+        }
+        sparse.add_term(i, coeffs[i] != 1);
+    }
+    return sparse;
+}
+
+AVXPolynomial SparseTernaryPoly::to_polynomial() const {
+    AlignedVector<uint32_t> coeffs(degree_, 0);
+    for (size_t t = 0; t < positions_.size(); ++t) {
+        uint32_t& c = coeffs[positions_[t]];
+        c = negative_[t] ? (c + modulus_ - 1) % modulus_ : (c + 1) % modulus_;
+    }
+    AVXPolynomial poly(degree_, modulus_);
+    poly.copy_from(coeffs.data());
+    return poly;
+}
+
+void SparseTernaryPoly::multiply(const AVXPolynomial& dense, AVXPolynomial& result) const {
+    using namespace poly_expr_detail;
+    check_compatible(degree_, modulus_, dense.degree(), dense.modulus());
+    check_compatible(degree_, modulus_, result.degree(), result.modulus());
+
+    const uint32_t n = degree_;
+    const uint32_t q = modulus_;
+
+    // window = [a | -a | a]: the n-coefficient run starting at 2n - p is X^p * a,
+    // the one starting at n - p is -X^p * a (negacyclic wrap included)
+    AlignedVector<uint32_t> window(3 * n);
+    dense.copy_to(window.data());
+    for (uint32_t i = 0; i < n; ++i) {
+        window[n + i] = window[i] ? q - window[i] : 0;
+        window[2 * n + i] = window[i];
+    }
+
+    std::vector<const uint32_t*> starts(positions_.size());
+    for (size_t t = 0; t < positions_.size(); ++t) {
+        starts[t] = window.data() + (negative_[t] ? n : 2 * n) - positions_[t];
+    }
+
+    // Terms accumulated lazily before an in-register reduction is needed
+    const uint64_t lazy_terms = std::numeric_limits<uint32_t>::max() / q - 1;
+    const __m256i vq = lane_set1(q);
+    const __m256i vm = lane_set1(barrett_constant(q));
+    __m256i* out = result.avx_coeffs();
+
+    // Four blocks per pass keep independent accumulator chains in flight
+    const uint32_t blocks = n / 8;
+    const size_t terms = starts.size();
+    for (uint32_t b = 0; b < blocks; b += 4) {
+        const uint32_t count = std::min<uint32_t>(4, blocks - b);
+        __m256i acc[4] = {lane_set1(0), lane_set1(0), lane_set1(0), lane_set1(0)};
+        uint64_t bound = 0;
+        for (size_t t = 0; t < terms;) {
+            if (bound > lazy_terms) {
+                for (uint32_t k = 0; k < count; ++k) acc[k] = lane_reduce(acc[k], vq, vm);
+                bound = 1;
+            }
+            const size_t chunk_end = std::min<size_t>(terms, t + (lazy_terms + 1 - bound));
+            bound += chunk_end - t;
+            for (; t < chunk_end; ++t) {
+                const uint32_t* src = starts[t] + 8 * b;
+                for (uint32_t k = 0; k < count; ++k) {
+                    acc[k] = lane_add(acc[k], load_unaligned(src + 8 * k));
+                }
+            }
+        }
+        for (uint32_t k = 0; k < count; ++k) {
+            out[b + k] = reduce_bounded(acc[k], static_cast<uint32_t>(bound), vq, vm);
+        }
+    }
+}
+
+} // namespace clwe
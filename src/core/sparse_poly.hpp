@@ -0,0 +1,43 @@
+#ifndef SPARSE_POLY_HPP
+#define SPARSE_POLY_HPP
+
+#include "polynomial.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace clwe {
+
+// Polynomial in Z_q[X]/(X^n + 1) with few nonzero coefficients, all +-1,
+// such as a signature challenge. Products with a dense polynomial are a
+// rotate-and-add over the nonzero positions, which for small weights is
+// cheaper than a pointwise NTT product plus an inverse transform.
+class SparseTernaryPoly {
+private:
+    uint32_t degree_;
+    uint32_t modulus_;
+    std::vector<uint32_t> positions_;
+    std::vector<uint8_t> negative_;
+
+public:
+    SparseTernaryPoly(uint32_t degree, uint32_t modulus);
+
+    // Adds +X^position, or -X^position when negative is set
+    void add_term(uint32_t position, bool negative);
+
+    // Throws std::invalid_argument unless every coefficient is 0, 1 or q - 1
+    static SparseTernaryPoly from_polynomial(const AVXPolynomial& poly);
+    AVXPolynomial to_polynomial() const;
+
+    // result = this * dense mod (X^n + 1); result may not alias dense
+    void multiply(const AVXPolynomial& dense, AVXPolynomial& result) const;
+
+    size_t weight() const { return positions_.size(); }
+    uint32_t degree() const { return degree_; }
+    uint32_t modulus() const { return modulus_; }
+    const std::vector<uint32_t>& positions() const { return positions_; }
+    const std::vector<uint8_t>& negative() const { return negative_; }
+};
+
+} // namespace clwe
+
+#endif // SPARSE_POLY_HPP
@@ -1,4 +1,6 @@
 #include "utils.hpp"
+#include "modular_reduction.hpp"
+#include "pool_allocator.hpp"
 #include <cstring>
 #include <chrono>
 #include <iostream>
@@ -11,20 +13,13 @@ namespace clwe {
 
 
 // AVX-Aligned Memory Allocator Implementation
+// Backed by the size-class pool; blocks are 64-byte aligned
 void* AVXAllocator::allocate(size_t size) {
-#ifdef HAVE_AVX2
-    return _mm_malloc(size, 32);  // 32-byte alignment for AVX
-#else
-    return malloc(size);  // Standard allocation for non-AVX
-#endif
+    return PoolAllocator::allocate(size);
 }
 
 void AVXAllocator::deallocate(void* ptr) {
-#ifdef HAVE_AVX2
-    _mm_free(ptr);
-#else
-    free(ptr);  // Standard deallocation for non-AVX
-#endif
+    PoolAllocator::deallocate(ptr);
 }
 
 void* AVXAllocator::reallocate(void* ptr, size_t new_size) {
@@ -35,12 +30,13 @@ void* AVXAllocator::reallocate(void* ptr, size_t new_size) {
         deallocate(ptr);
         return nullptr;
     }
-    void* new_ptr = allocate(new_size);
-    if (new_ptr) {
-        // We don't know the old size, so we can't copy safely
-        // This is a limitation - reallocate should be used carefully
-        deallocate(ptr);
+    size_t old_size = PoolAllocator::block_size(ptr);
+    if (new_size <= old_size) {
+        return ptr;
     }
+    void* new_ptr = allocate(new_size);
+    memcpy(new_ptr, ptr, old_size);
+    deallocate(ptr);
     return new_ptr;
 }
 
@@ -96,13 +92,9 @@ void AVXVector<T>::resize(size_t new_size) {
 template<typename T>
 void AVXVector<T>::reserve(size_t new_capacity) {
     if (new_capacity > capacity_) {
-        T* new_data = static_cast<T*>(AVXAllocator::allocate(new_capacity * sizeof(T)));
-        if (data_) {
-            memcpy(new_data, data_, size_ * sizeof(T));
-            AVXAllocator::deallocate(data_);
-        }
-        data_ = new_data;
-        capacity_ = new_capacity;
+        // reallocate moves the contents and may grow into the block's slack
+        data_ = static_cast<T*>(AVXAllocator::reallocate(data_, new_capacity * sizeof(T)));
+        capacity_ = PoolAllocator::block_size(data_) / sizeof(T);
     }
 }
 
@@ -134,9 +126,21 @@ void AVXVector<T>::pop_back() {
     }
 }
 
-// Explicit template instantiations
+// Explicit template instantiations. The vector types' alignment attributes
+// do not affect AVXVector, which aligns its own storage; GCC reports them as
+// ignored template-argument attributes.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
 template class AVXVector<uint32_t>;
 template class AVXVector<__m256i>;
+#ifdef HAVE_AVX512
+template class AVXVector<__m512i>;
+#endif
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 // Utility functions
 uint64_t get_timestamp_ns() {
@@ -150,22 +154,12 @@ double timestamp_to_ms(uint64_t ts) {
 
 // Montgomery reduction
 uint32_t montgomery_reduce(uint64_t a, uint32_t q) {
-    uint64_t t = a * (static_cast<uint64_t>(1) << 32) % q;
-    return (a + t * q) >> 32;
-}
-
-uint32_t montgomery_reduce_avx(__m256i a, uint32_t q) {
-    // This will be implemented in AVX-specific code
-    // For now, return 0 as placeholder
-    return 0;
+    return MontgomeryReducer(q).reduce(a);
 }
 
 // Barrett reduction
-uint32_t barrett_reduce(uint64_t a, uint32_t q, uint64_t mu) {
-    uint64_t t = (a * mu) >> 32;
-    uint64_t r = a - t * q;
-    if (r >= q) r -= q;
-    return static_cast<uint32_t>(r);
+uint32_t barrett_reduce(uint32_t a, uint32_t q) {
+    return BarrettReducer(q).reduce(a);
 }
 
 // Bit operations
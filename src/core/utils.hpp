@@ -4,6 +4,9 @@
 #include <cstdint>
 #include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 #ifdef HAVE_AVX2
 #include <immintrin.h>
@@ -15,17 +18,65 @@ typedef struct { uint32_t m[8]; } __m256i;
 namespace clwe {
 
 
-// AVX-Aligned Memory Allocator
+// AVX-Aligned Memory Allocator, backed by PoolAllocator (pool_allocator.hpp)
 class AVXAllocator {
 public:
     static void* allocate(size_t size);
     static void deallocate(void* ptr);
+    // Preserves the contents up to the smaller of the two sizes
     static void* reallocate(void* ptr, size_t new_size);
 };
 
-// AVX-Aligned Vector Template
+// Standard allocator over AVXAllocator, for std::vector and friends.
+// Alignments up to 64 bytes come from the pool; larger ones go to
+// aligned operator new.
+template<typename T, size_t Alignment = 64>
+class AlignedAllocator {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment below the type's own");
+
+public:
+    using value_type = T;
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        if (Alignment > 64) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+        }
+        return static_cast<T*>(AVXAllocator::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        if (Alignment > 64) {
+            ::operator delete(ptr, std::align_val_t(Alignment));
+        } else {
+            AVXAllocator::deallocate(ptr);
+        }
+    }
+};
+
+template<typename T, typename U, size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) noexcept { return true; }
+template<typename T, typename U, size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) noexcept { return false; }
+
+// Coefficient buffers handed to SIMD kernels
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// AVX-Aligned Vector Template, for trivially copyable element types
 template<typename T>
 class AVXVector {
+    static_assert(std::is_trivially_copyable<T>::value, "AVXVector grows by copying bytes");
+
 private:
     T* data_;
     size_t size_;
@@ -66,12 +117,11 @@ public:
 uint64_t get_timestamp_ns();
 double timestamp_to_ms(uint64_t ts);
 
-// Montgomery reduction utilities
+// One-off reductions; hot loops should hold a policy from modular_reduction.hpp
+// a * 2^(-32) mod q for odd q < 2^31 and a < q * 2^32
 uint32_t montgomery_reduce(uint64_t a, uint32_t q);
-uint32_t montgomery_reduce_avx(__m256i a, uint32_t q); // Forward declare for AVX
-
-// Barrett reduction
-uint32_t barrett_reduce(uint64_t a, uint32_t q, uint64_t mu);
+// a mod q for any 32-bit a and q < 2^30
+uint32_t barrett_reduce(uint32_t a, uint32_t q);
 
 // Bit operations
 int bit_length(uint32_t x);
@@ -0,0 +1,98 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Cycle counters around the library's hot paths.
+//
+// Built with CLWE_ENABLE_INSTRUMENTATION (CMake option of the same name),
+// CLWE_INSTRUMENT(op) scopes in the library add the elapsed cycle-counter
+// ticks and a call count to per-thread counters. Recording takes no locks;
+// instrumentation_snapshot() sums every live thread plus threads that have
+// exited. Without the option the scopes compile to nothing and snapshots stay
+// zero.
+//
+// Timings are inclusive: a pointwise multiply inside an encapsulation counts
+// towards both. A scope nested inside the same operation on the same thread
+// is not counted again.
+
+namespace clwe {
+
+enum class InstrumentedOp : uint32_t {
+    MatrixExpansion,
+    Sampling,
+    NTTForward,
+    NTTInverse,
+    PointwiseMultiply,
+    Serialization,
+    Deserialization,
+    KeyGen,
+    Encapsulate,
+    Decapsulate,
+    Sign,
+    Verify,
+    Count
+};
+
+constexpr size_t INSTRUMENTED_OP_COUNT = static_cast<size_t>(InstrumentedOp::Count);
+
+const char* instrumented_op_name(InstrumentedOp op);
+
+constexpr bool instrumentation_enabled() {
+#ifdef CLWE_ENABLE_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+// rdtsc on x86, the virtual counter on AArch64, steady_clock nanoseconds elsewhere
+uint64_t read_cycle_counter();
+// Ticks of read_cycle_counter() per second, calibrated once against steady_clock
+double cycle_counter_frequency();
+
+struct InstrumentationCounter {
+    uint64_t calls = 0;
+    uint64_t cycles = 0;
+};
+
+struct InstrumentationSnapshot {
+    std::array<InstrumentationCounter, INSTRUMENTED_OP_COUNT> counters{};
+
+    const InstrumentationCounter& operator[](InstrumentedOp op) const {
+        return counters[static_cast<size_t>(op)];
+    }
+};
+
+InstrumentationSnapshot instrumentation_snapshot();
+// Counts recorded concurrently with a reset may be lost
+void reset_instrumentation();
+
+// Adds the cycles between construction and destruction to `op` on this thread
+class ScopedCycleTimer {
+private:
+    InstrumentedOp op_;
+    uint64_t start_;
+    bool outermost_;
+
+public:
+    explicit ScopedCycleTimer(InstrumentedOp op);
+    ~ScopedCycleTimer();
+
+    ScopedCycleTimer(const ScopedCycleTimer&) = delete;
+    ScopedCycleTimer& operator=(const ScopedCycleTimer&) = delete;
+};
+
+} // namespace clwe
+
+#ifdef CLWE_ENABLE_INSTRUMENTATION
+#define CLWE_INSTRUMENT_CONCAT_(a, b) a##b
+#define CLWE_INSTRUMENT_NAME_(line) CLWE_INSTRUMENT_CONCAT_(clwe_instrument_scope_, line)
+#define CLWE_INSTRUMENT(op) ::clwe::ScopedCycleTimer CLWE_INSTRUMENT_NAME_(__LINE__)(::clwe::InstrumentedOp::op)
+#else
+#define CLWE_INSTRUMENT(op) static_cast<void>(0)
+#endif
+
+#endif // INSTRUMENTATION_HPP
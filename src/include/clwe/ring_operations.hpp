@@ -6,6 +6,7 @@
 #include <vector>
 #include <cstdint>
 #include <array>
+#include <memory_resource>
 
 namespace clwe {
 
@@ -33,6 +34,9 @@ private:
                           AVXPolynomial& result) const;
 
 public:
+    // Methods returning polynomials take an optional memory resource that
+    // backs the results and all scratch polynomials; nullptr means
+    // current_memory_resource(). Results must not outlive the resource.
     RingOperations(const CLWEParameters& params, AVXNTTEngine* ntt_engine);
     ~RingOperations();
 
@@ -41,12 +45,15 @@ public:
     RingOperations& operator=(const RingOperations&) = delete;
 
     // Deterministic matrix A generation from seed
-    std::vector<std::vector<AVXPolynomial>> generate_matrix_A(const std::array<uint8_t, 32>& seed) const;
+    std::vector<std::vector<AVXPolynomial>> generate_matrix_A(const std::array<uint8_t, 32>& seed,
+                                                              std::pmr::memory_resource* resource = nullptr) const;
 
     // Binomial sampling
-    AVXPolynomial sample_binomial(uint32_t eta, const std::array<uint8_t, 32>& randomness) const;
+    AVXPolynomial sample_binomial(uint32_t eta, const std::array<uint8_t, 32>& randomness,
+                                  std::pmr::memory_resource* resource = nullptr) const;
     std::vector<AVXPolynomial> sample_binomial_batch(uint32_t eta, uint32_t count,
-                                                   const std::array<uint8_t, 32>& seed) const;
+                                                   const std::array<uint8_t, 32>& seed,
+                                                   std::pmr::memory_resource* resource = nullptr) const;
 
     // AVX-optimized polynomial operations
     void poly_add_avx(const AVXPolynomial& a, const AVXPolynomial& b, AVXPolynomial& result) const;
@@ -55,21 +62,26 @@ public:
 
     // Matrix-vector operations
     std::vector<AVXPolynomial> matrix_vector_mul(const std::vector<std::vector<AVXPolynomial>>& A,
-                                                const std::vector<AVXPolynomial>& v) const;
+                                                const std::vector<AVXPolynomial>& v,
+                                                std::pmr::memory_resource* resource = nullptr) const;
     std::vector<AVXPolynomial> matrix_transpose_vector_mul(const std::vector<std::vector<AVXPolynomial>>& A,
-                                                          const std::vector<AVXPolynomial>& v) const;
+                                                          const std::vector<AVXPolynomial>& v,
+                                                          std::pmr::memory_resource* resource = nullptr) const;
 
     // Inner product
     AVXPolynomial inner_product(const std::vector<AVXPolynomial>& a,
-                               const std::vector<AVXPolynomial>& b) const;
+                               const std::vector<AVXPolynomial>& b,
+                               std::pmr::memory_resource* resource = nullptr) const;
 
     // Utility functions
-    AVXPolynomial encode_message_to_poly(const std::vector<uint8_t>& message) const;
+    AVXPolynomial encode_message_to_poly(const std::vector<uint8_t>& message,
+                                         std::pmr::memory_resource* resource = nullptr) const;
     std::vector<uint8_t> decode_poly_to_message(const AVXPolynomial& poly) const;
 
     // Serialization
     std::vector<uint8_t> serialize_polynomial(const AVXPolynomial& poly) const;
-    AVXPolynomial deserialize_polynomial(const std::vector<uint8_t>& data) const;
+    AVXPolynomial deserialize_polynomial(const std::vector<uint8_t>& data,
+                                         std::pmr::memory_resource* resource = nullptr) const;
 
     // Getters
     const CLWEParameters& params() const { return params_; }
@@ -3,28 +3,67 @@
 
 #include "clwe.hpp"
 #include "ring_operations.hpp"
+#include "sparse_poly.hpp"
+#include "poly_rounding.hpp"
 #include <vector>
 #include <array>
 #include <memory>
+#include <map>
+#include <mutex>
+#include <string>
 
 namespace clwe {
 
-// Forward declarations
-class RingOperations;
+// Signature modulus q = 2^23 - 2^13 + 1. The KEM modulus 3329 leaves no room
+// for the high/low-bits rounding of Fiat-Shamir with aborts, so Sign always
+// works over this prime whatever CLWEParameters::modulus says.
+constexpr uint32_t SIGN_MODULUS = 8380417;
+
+// Per-level signing parameters (Dilithium-style)
+struct SignParameters {
+    uint32_t k;       // Rows of A (length of t, w and s2)
+    uint32_t l;       // Columns of A (length of y, z and s1)
+    uint32_t eta;     // Secret coefficient bound
+    uint32_t tau;     // Number of +-1 coefficients in the challenge
+    uint32_t beta;    // tau * eta
+    uint32_t gamma1;  // Mask coefficient range
+    uint32_t gamma2;  // Low-order rounding range
+    uint32_t omega;   // Maximum number of hint bits
+    uint32_t d;       // Bits dropped from t
+
+    static SignParameters for_security_level(uint32_t security_level);
+};
+
+// k x l matrix of polynomials in NTT form
+using SignMatrix = std::vector<std::vector<AVXPolynomial>>;
 
 // Key structures
 struct SignPublicKey {
-    std::array<uint8_t, 32> seed;
-    std::vector<AVXPolynomial> public_polys;
+    std::array<uint8_t, 32> seed;                // rho, expands A
+    std::vector<AVXPolynomial> public_polys;     // t1
+    std::array<uint8_t, 64> tr;                  // H(serialized public key)
+    std::shared_ptr<const SignMatrix> matrix_A;  // Expanded A, not serialized
     CLWEParameters params;
 
     std::vector<uint8_t> serialize() const;
     static SignPublicKey deserialize(const std::vector<uint8_t>& data);
 };
 
+// Secret polynomials are kept in NTT form so signing only needs pointwise
+// products and one inverse NTT per output polynomial.
 struct SignPrivateKey {
-    std::array<uint8_t, 32> seed;
-    std::vector<AVXPolynomial> secret_polys;
+    std::array<uint8_t, 32> seed;                // rho
+    std::array<uint8_t, 32> key;                 // K, keys the per-signature mask seed
+    std::array<uint8_t, 64> tr;
+    std::vector<AVXPolynomial> s1_ntt;
+    std::vector<AVXPolynomial> s2_ntt;
+    std::vector<AVXPolynomial> t0_ntt;
+    // Coefficient-form copies for the sparse challenge product; filled by keygen
+    // and Sign::expand_private_key, not serialized
+    std::vector<AVXPolynomial> s1;
+    std::vector<AVXPolynomial> s2;
+    std::vector<AVXPolynomial> t0;
+    std::shared_ptr<const SignMatrix> matrix_A;  // Shared with the public key, not serialized
     CLWEParameters params;
 
     std::vector<uint8_t> serialize() const;
@@ -32,20 +71,108 @@ struct SignPrivateKey {
 };
 
 struct Signature {
+    std::array<uint8_t, 32> c;                   // Challenge seed, expands to the sparse +-1 polynomial
     std::vector<AVXPolynomial> z_polys;
-    uint32_t c;
+    std::vector<AVXPolynomial> hint_polys;       // 0/1 coefficients
     CLWEParameters params;
 
     std::vector<uint8_t> serialize() const;
     static Signature deserialize(const std::vector<uint8_t>& data);
 };
 
+// Message-independent part of a signing attempt: mask y, w = A*y and HighBits(w)
+struct SignCommitment {
+    std::vector<AVXPolynomial> y;
+    std::vector<AVXPolynomial> w;
+    std::vector<AVXPolynomial> w1;
+};
+
+// Challenge polynomial, plus its NTT when products take the dense path
+struct SignChallenge {
+    SparseTernaryPoly sparse;
+    AVXPolynomial ntt;
+};
+
+class SignCommitmentPool;
+class SignAttemptPool;
+
+// Incremental mu = H(tr || M) for messages that arrive in pieces
+class SignMessageHasher {
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+
+public:
+    explicit SignMessageHasher(const std::array<uint8_t, 64>& tr);
+    ~SignMessageHasher();
+
+    SignMessageHasher(const SignMessageHasher&) = delete;
+    SignMessageHasher& operator=(const SignMessageHasher&) = delete;
+
+    // Restarts hashing for a new message
+    void init(const std::array<uint8_t, 64>& tr);
+    void update(const uint8_t* data, size_t len);
+    std::array<uint8_t, 64> final();
+};
+
+// One entry of a batch verification; the pointed-to objects must outlive the call
+struct SignVerifyItem {
+    const SignPublicKey* public_key;
+    const std::vector<uint8_t>* message;
+    const Signature* signature;
+};
+
 // Fiat-Shamir signature scheme with rejection sampling
 class Sign {
 private:
     CLWEParameters params_;
-    std::unique_ptr<RingOperations> ring_ops_;
+    SignParameters sign_params_;
+    PolyRounding rounding_;    // Power2Round, HighBits/LowBits and hints
     std::unique_ptr<AVXNTTEngine> ntt_engine_;
+    uint32_t parallel_attempts_;
+    std::unique_ptr<SignAttemptPool> attempt_pool_;  // Workers for parallel_attempts_ > 1
+    bool sparse_challenge_;    // c * v by rotate-and-add instead of NTT (small tau)
+
+    // Precomputed commitments, keyed by the private key's K
+    std::map<std::array<uint8_t, 32>, std::shared_ptr<SignCommitmentPool>> pools_;
+    mutable std::mutex pools_mutex_;
+
+    friend class SignCommitmentPool;
+    std::shared_ptr<SignCommitmentPool> find_pool(const SignPrivateKey& private_key) const;
+
+    std::array<uint8_t, 64> hash_file(const std::array<uint8_t, 64>& tr, const std::string& path) const;
+
+    SignMatrix expand_matrix(const std::array<uint8_t, 32>& seed) const;
+    std::vector<AVXPolynomial> sample_secret(const std::array<uint8_t, 64>& seed, uint16_t nonce,
+                                             uint32_t count) const;
+    std::vector<AVXPolynomial> sample_mask(const std::array<uint8_t, 64>& seed, uint16_t nonce) const;
+    SparseTernaryPoly sample_challenge(const std::array<uint8_t, 32>& c) const;
+    SignChallenge make_challenge(const std::array<uint8_t, 32>& c) const;
+
+    // Row-wise A * v for v in NTT form; each row gets one inverse NTT
+    std::vector<AVXPolynomial> matrix_vector_ntt(const SignMatrix& A,
+                                                 const std::vector<AVXPolynomial>& v_ntt) const;
+    // c * v for every polynomial of v, in coefficient form. The sparse path reads v,
+    // the NTT path reads v_ntt (v in NTT form).
+    std::vector<AVXPolynomial> challenge_product(const SignChallenge& c, const std::vector<AVXPolynomial>& v,
+                                                 const std::vector<AVXPolynomial>& v_ntt) const;
+    void to_ntt(std::vector<AVXPolynomial>& polys) const;
+
+    SignCommitment compute_commitment(const SignMatrix& A, const std::array<uint8_t, 64>& rho_prime,
+                                      uint16_t kappa) const;
+    // Challenge, response and rejection checks; false when the attempt is rejected
+    bool respond(const SignPrivateKey& private_key, const SignCommitment& commitment,
+                 const std::array<uint8_t, 64>& mu, Signature& signature) const;
+    // t1 * 2^d, the public-key side of w' = A*z - c*t1*2^d; t1_ntt only on the NTT path
+    void scaled_t1(const SignPublicKey& public_key, std::vector<AVXPolynomial>& t1,
+                   std::vector<AVXPolynomial>& t1_ntt) const;
+    // Shape, norm and hint checks that need no arithmetic
+    bool signature_well_formed(const SignPublicKey& public_key, const Signature& signature) const;
+    // verify_digest for a signature that already passed signature_well_formed
+    bool verify_well_formed(const SignPublicKey& public_key, const std::array<uint8_t, 64>& mu,
+                            const Signature& signature) const;
+    uint32_t w1_bits() const;
+
 
 public:
     Sign(const CLWEParameters& params);
@@ -60,23 +187,62 @@ public:
 
     // Signing
     Signature sign(const SignPrivateKey& private_key, const std::vector<uint8_t>& message);
+    // Signs a digest from SignMessageHasher (initialized with private_key.tr)
+    Signature sign_digest(const SignPrivateKey& private_key, const std::array<uint8_t, 64>& mu);
+    // Streams the file through the hasher; memory use does not grow with file size
+    Signature sign_file(const SignPrivateKey& private_key, const std::string& path);
+
+    // Number of candidate masks tried concurrently per signing round (default 1;
+    // 0 picks one per physical core). The accepted signature is the one sequential
+    // signing would return. Rounds run on attempts - 1 persistent worker threads
+    // plus the calling thread.
+    void set_parallel_attempts(uint32_t attempts);
+    uint32_t parallel_attempts() const { return parallel_attempts_; }
+
+    // Offline/online signing: a background thread keeps up to `capacity` commitments
+    // (y, w = A*y, HighBits(w)) ready for private_key, and sign() with that key then
+    // only hashes the message and computes the response. Each commitment is used once.
+    // A capacity of 0 keeps as many commitments as fit in half of the L2 cache.
+    void start_precomputation(const SignPrivateKey& private_key, size_t capacity = 0);
+    void stop_precomputation(const SignPrivateKey& private_key);
+    size_t precomputed_commitments(const SignPrivateKey& private_key) const;
 
     // Verification
     bool verify(const SignPublicKey& public_key, const std::vector<uint8_t>& message,
                const Signature& signature) const;
+    bool verify_digest(const SignPublicKey& public_key, const std::array<uint8_t, 64>& mu,
+                       const Signature& signature) const;
+    bool verify_file(const SignPublicKey& public_key, const std::string& path,
+                     const Signature& signature) const;
+
+    // Batch verification: bit i of the result (word i / 64, bit i % 64) is set when
+    // items[i] verifies. Items sharing a seed share one expanded A, and their A*z
+    // products are computed block-wise so each A[i][j] is reused across signatures.
+    std::vector<uint64_t> verify_batch(const std::vector<SignVerifyItem>& items) const;
 
     // Key verification
     bool verify_keypair(const SignPublicKey& public_key, const SignPrivateKey& private_key) const;
 
+    // Fills in the expanded matrix (and coefficient-form secrets) of a deserialized key.
+    // Run it once after loading a private key: signing with an unexpanded key
+    // rebuilds both on every call. The caller owns the expanded secrets.
+    void expand_public_key(SignPublicKey& public_key) const;
+    void expand_private_key(SignPrivateKey& private_key) const;
+
     // Helper functions (public for benchmarking)
-    uint32_t compute_challenge(const std::vector<AVXPolynomial>& w_polys,
-                              const std::vector<uint8_t>& message) const;
+    std::array<uint8_t, 64> compute_message_digest(const std::array<uint8_t, 64>& tr,
+                                                   const std::vector<uint8_t>& message) const;
+    std::array<uint8_t, 32> compute_challenge(const std::vector<AVXPolynomial>& w1_polys,
+                                              const std::array<uint8_t, 64>& mu) const;
     int poly_infty_norm(const std::vector<AVXPolynomial>& polys) const;
+    // Rejection test: true as soon as any coefficient reaches bound
+    bool polys_exceed_norm(const std::vector<AVXPolynomial>& polys, uint32_t bound) const;
 
     // Getters
     const CLWEParameters& params() const { return params_; }
+    const SignParameters& sign_params() const { return sign_params_; }
 };
 
 } // namespace clwe
 
-#endif // SIGN_HPP
\ No newline at end of file
+#endif // SIGN_HPP